@@ -1,21 +1,28 @@
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
 class User {
 private:
     string name;
     string accountNumber;
-    int money;
+    // Atomic so the same account can be served by several terminals at once.
+    atomic<int> money;
     int pin;
 public:
     User(string name, string ac, int pass, int m) : name(name), accountNumber(ac), pin(pass), money(m) {}
     void addMoney(int amount) {
-        money += amount;
+        money.fetch_add(amount);
     }
     bool withdrawMoney(int amount) {
-        if (money >= amount) {
-            money -= amount;
-            return true;
+        int current = money.load();
+        while (current >= amount) {
+            if (money.compare_exchange_weak(current, current - amount)) {
+                return true;
+            }
         }
         return false;
     }
@@ -38,14 +45,83 @@ public:
     virtual void addMoney(int val, int cnt) = 0;
     virtual bool canProcess(int amount) = 0;
     virtual void performTransaction() = 0;
+    // Notes the last successful canProcess would dispense.
+    virtual const map<int, int> &getLastPlan() const = 0;
+};
+
+// Finds a note mix for an amount from a bounded cassette. Denominations are
+// tried largest first and each count is taken in one division, so the first
+// plan found keeps as many small notes as possible. Dead (denomination,
+// remainder) states are memoised, which keeps the backtracking bounded.
+class DispensePlanner {
+private:
+    vector<pair<int, int>> notes; // (denomination, count), largest first
+    vector<long long> suffixCash;
+    set<pair<int, int>> dead;
+
+    bool search(size_t i, int remaining, vector<int> &take) {
+        if (remaining == 0) {
+            return true;
+        }
+        if (i == notes.size() || suffixCash[i] < remaining || dead.count({(int)i, remaining})) {
+            return false;
+        }
+        int denomination = notes[i].first;
+        for (int t = min(notes[i].second, remaining / denomination); t >= 0; t--) {
+            int rest = remaining - t * denomination;
+            if (suffixCash[i + 1] < rest) {
+                break;
+            }
+            take[i] = t;
+            if (search(i + 1, rest, take)) {
+                return true;
+            }
+        }
+        take[i] = 0;
+        dead.insert({(int)i, remaining});
+        return false;
+    }
+public:
+    bool plan(const map<int, int> &cassette, int amount, map<int, int> &out) {
+        out.clear();
+        if (amount <= 0) {
+            return amount == 0;
+        }
+        notes.assign(cassette.rbegin(), cassette.rend());
+        suffixCash.assign(notes.size() + 1, 0);
+        for (int i = (int)notes.size() - 1; i >= 0; i--) {
+            suffixCash[i] = suffixCash[i + 1] + (long long)notes[i].first * notes[i].second;
+        }
+        dead.clear();
+        vector<int> take(notes.size(), 0);
+        if (!search(0, amount, take)) {
+            return false;
+        }
+        for (size_t i = 0; i < notes.size(); i++) {
+            if (take[i]) {
+                out[notes[i].first] = take[i];
+            }
+        }
+        return true;
+    }
 };
 
 class Cash : public ICash {
 private:
     map<int, int> money; 
     map<int, int> transaction;
+    DispensePlanner planner;
+    // Plans are only valid for the cassette counts they were made from,
+    // so any change to `money` clears the cache.
+    unordered_map<int, map<int, int>> planCache;
+    unordered_set<int> unpayable;
     static Cash* instance;
     Cash() {};
+    friend class ATMNetwork;
+    void invalidatePlans() {
+        planCache.clear();
+        unpayable.clear();
+    }
 public: 
     static Cash* getInstance() {
         if (!instance) {
@@ -55,25 +131,32 @@ public:
     }
     void addMoney(int val, int cnt) override {
         money[val] += cnt;
+        invalidatePlans();
     }
     bool canProcess(int amount) override {
-        int sum = amount;
         transaction.clear();
-        for (auto &x : money) {
-            int denomination = x.first;
-            int count = x.second;
-            while (sum >= denomination && count) {
-                count--;
-                sum -= denomination;
-                transaction[denomination]++;
-            }
+        if (unpayable.count(amount)) {
+            return false;
+        }
+        auto cached = planCache.find(amount);
+        if (cached != planCache.end()) {
+            transaction = cached->second;
+            return true;
+        }
+        if (!planner.plan(money, amount, transaction)) {
+            unpayable.insert(amount);
+            return false;
         }
-        return sum == 0; 
+        planCache[amount] = transaction;
+        return true;
     }
     void performTransaction() override {
         for (auto &x : transaction) {
             money[x.first] -= x.second;
         }
+        if (!transaction.empty()) {
+            invalidatePlans();
+        }
         transaction.clear();
     }
     int getTotalCash() {
@@ -83,13 +166,702 @@ public:
         }
         return total;
     }
+    const map<int, int> &getLastPlan() const override {
+        return transaction;
+    }
+};
+
+// Fixed-size account row, laid out exactly as it sits in a snapshot file.
+struct AccountRecord {
+    uint64_t hash;
+    char accountNumber[16];
+    char name[24];
+    int32_t pin;
+    int32_t balance;
+};
+
+// Open-addressing (linear probing) map from account number to AccountRecord.
+// Each slot holds the top 32 bits of the account's hash next to its record
+// index, so a probe only touches a record when the tags match, and growth
+// rehashes from the hash stored in each record. The table can be built in
+// memory or mapped straight from a snapshot written by saveSnapshot.
+class AccountDirectory {
+public:
+    static const uint32_t NotFound = UINT32_MAX;
+private:
+    struct Slot {
+        uint32_t tag;
+        uint32_t recordPlusOne; // 0 = empty
+    };
+    struct SnapshotHeader {
+        char magic[8];
+        uint64_t slotCount;
+        uint64_t recordCount;
+    };
+    static constexpr char Magic[8] = {'A', 'T', 'M', 'D', 'I', 'R', '1', 0};
+
+    vector<Slot> ownedSlots;
+    vector<AccountRecord> ownedRecords;
+    const Slot *slots = nullptr;
+    AccountRecord *records = nullptr;
+    uint64_t slotCount = 0, recordCount = 0;
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+
+    static uint32_t tagOf(uint64_t hash) {
+        return (uint32_t)(hash >> 32);
+    }
+    void useOwned() {
+        slots = ownedSlots.data();
+        records = ownedRecords.data();
+        slotCount = ownedSlots.size();
+        recordCount = ownedRecords.size();
+    }
+    void placeSlot(uint64_t hash, uint32_t record) {
+        uint64_t mask = ownedSlots.size() - 1;
+        for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+            if (!ownedSlots[i].recordPlusOne) {
+                ownedSlots[i] = {tagOf(hash), record + 1};
+                return;
+            }
+        }
+    }
+    void rehash(uint64_t newSlotCount) {
+        ownedSlots.assign(newSlotCount, Slot{0, 0});
+        for (uint32_t r = 0; r < ownedRecords.size(); r++) {
+            placeSlot(ownedRecords[r].hash, r);
+        }
+    }
+    // A mapped snapshot is read-only; copy it into owned storage before writing.
+    void detach() {
+        if (!mapping) {
+            return;
+        }
+        ownedSlots.assign(slots, slots + slotCount);
+        ownedRecords.assign(records, records + recordCount);
+        unmap();
+        useOwned();
+    }
+    void unmap() {
+        if (mapping) {
+            munmap(mapping, mappingSize);
+            mapping = nullptr;
+        }
+    }
+    // Everything find() and record() rely on: sizes that add up, every slot
+    // pointing at a distinct record inside the file, one slot per record (so
+    // probes always reach an empty slot) and NUL-terminated strings.
+    static bool validSnapshot(const SnapshotHeader *header, size_t fileSize) {
+        uint64_t slotCount = header->slotCount, recordCount = header->recordCount;
+        if (memcmp(header->magic, Magic, sizeof(Magic)) != 0 || (slotCount & (slotCount - 1)) ||
+            slotCount > fileSize / sizeof(Slot) || recordCount > fileSize / sizeof(AccountRecord) ||
+            recordCount * 4 > slotCount * 3 ||
+            sizeof(SnapshotHeader) + slotCount * sizeof(Slot) + recordCount * sizeof(AccountRecord) != fileSize) {
+            return false;
+        }
+        const Slot *slots = (const Slot *)(header + 1);
+        const AccountRecord *records = (const AccountRecord *)(slots + slotCount);
+        vector<bool> referenced(recordCount, false);
+        uint64_t occupied = 0;
+        for (uint64_t i = 0; i < slotCount; i++) {
+            if (!slots[i].recordPlusOne) {
+                continue;
+            }
+            uint32_t r = slots[i].recordPlusOne - 1;
+            if (r >= recordCount || referenced[r]) {
+                return false;
+            }
+            referenced[r] = true;
+            occupied++;
+        }
+        if (occupied != recordCount) {
+            return false;
+        }
+        for (uint64_t r = 0; r < recordCount; r++) {
+            if (!memchr(records[r].accountNumber, 0, sizeof(records[r].accountNumber)) ||
+                !memchr(records[r].name, 0, sizeof(records[r].name))) {
+                return false;
+            }
+        }
+        return true;
+    }
+public:
+    static uint64_t hashOf(const char *acc, size_t len) {
+        uint64_t h = 1469598103934665603ULL; // FNV-1a
+        for (size_t i = 0; i < len; i++) {
+            h = (h ^ (unsigned char)acc[i]) * 1099511628211ULL;
+        }
+        return h;
+    }
+    AccountDirectory() = default;
+    AccountDirectory(const AccountDirectory &) = delete;
+    AccountDirectory &operator=(const AccountDirectory &) = delete;
+    ~AccountDirectory() {
+        unmap();
+    }
+    void reserve(size_t accounts) {
+        detach();
+        ownedRecords.reserve(accounts);
+        uint64_t wanted = 16;
+        while (wanted * 3 < accounts * 4 + 4) {
+            wanted <<= 1;
+        }
+        if (wanted > ownedSlots.size()) {
+            rehash(wanted);
+        }
+        useOwned();
+    }
+    uint32_t find(const string &acc) const {
+        return find(acc.data(), acc.size(), hashOf(acc.data(), acc.size()));
+    }
+    uint32_t find(const char *acc, size_t len, uint64_t hash) const {
+        if (!slotCount || len >= sizeof(AccountRecord::accountNumber)) {
+            return NotFound;
+        }
+        uint32_t tag = tagOf(hash);
+        uint64_t mask = slotCount - 1;
+        for (uint64_t i = hash & mask; slots[i].recordPlusOne; i = (i + 1) & mask) {
+            if (slots[i].tag != tag) {
+                continue;
+            }
+            const AccountRecord &rec = records[slots[i].recordPlusOne - 1];
+            if (rec.hash == hash && memcmp(rec.accountNumber, acc, len) == 0 && rec.accountNumber[len] == 0) {
+                return slots[i].recordPlusOne - 1;
+            }
+        }
+        return NotFound;
+    }
+    // Batch lookups call these a few keys ahead so the slot, then the record,
+    // are already in cache when find() gets to them.
+    void prefetchSlot(uint64_t hash) const {
+        if (slotCount) {
+            __builtin_prefetch(&slots[hash & (slotCount - 1)]);
+        }
+    }
+    void prefetchRecord(uint64_t hash) const {
+        if (slotCount && slots[hash & (slotCount - 1)].recordPlusOne) {
+            __builtin_prefetch(&records[slots[hash & (slotCount - 1)].recordPlusOne - 1]);
+        }
+    }
+    // Whether an account number and name fit a record without truncation.
+    static bool fits(const string &acc, const string &name) {
+        return acc.size() < sizeof(AccountRecord::accountNumber) && name.size() < sizeof(AccountRecord::name);
+    }
+    // Returns the record index, or NotFound if the account already exists or does not fit a record.
+    uint32_t insert(const string &acc, const string &name, int pin, int balance) {
+        if (!fits(acc, name) || find(acc) != NotFound) {
+            return NotFound;
+        }
+        detach();
+        if ((ownedRecords.size() + 1) * 4 > ownedSlots.size() * 3) {
+            rehash(max<uint64_t>(16, ownedSlots.size() * 2));
+        }
+        AccountRecord rec{};
+        rec.hash = hashOf(acc.data(), acc.size());
+        strncpy(rec.accountNumber, acc.c_str(), sizeof(rec.accountNumber) - 1);
+        strncpy(rec.name, name.c_str(), sizeof(rec.name) - 1);
+        rec.pin = pin;
+        rec.balance = balance;
+        ownedRecords.push_back(rec);
+        uint32_t index = (uint32_t)ownedRecords.size() - 1;
+        placeSlot(rec.hash, index);
+        useOwned();
+        return index;
+    }
+    const AccountRecord &record(uint32_t index) const {
+        return records[index];
+    }
+    size_t size() const {
+        return recordCount;
+    }
+    bool saveSnapshot(const string &path) const {
+        FILE *f = fopen(path.c_str(), "wb");
+        if (!f) {
+            return false;
+        }
+        SnapshotHeader header{};
+        memcpy(header.magic, Magic, sizeof(Magic));
+        header.slotCount = slotCount;
+        header.recordCount = recordCount;
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  fwrite(slots, sizeof(Slot), slotCount, f) == slotCount &&
+                  fwrite(records, sizeof(AccountRecord), recordCount, f) == recordCount;
+        return fclose(f) == 0 && ok;
+    }
+    // Maps the snapshot instead of reading it into owned storage. The one
+    // sequential validation pass is the only work proportional to the file.
+    bool loadSnapshot(const string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        void *base = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SnapshotHeader)) {
+            base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+        if (!validSnapshot((const SnapshotHeader *)base, st.st_size)) {
+            munmap(base, st.st_size);
+            return false;
+        }
+        const SnapshotHeader *header = (const SnapshotHeader *)base;
+        madvise(base, st.st_size, MADV_RANDOM);
+        unmap();
+        ownedSlots.clear();
+        ownedRecords.clear();
+        mapping = base;
+        mappingSize = st.st_size;
+        slotCount = header->slotCount;
+        recordCount = header->recordCount;
+        slots = (const Slot *)(header + 1);
+        records = (AccountRecord *)(slots + slotCount);
+        return true;
+    }
+};
+
+// Accounts shared by every terminal. Registration (addAccount, loadSnapshot)
+// happens before terminals start; after that logins and balance updates are
+// safe from any thread. Each account's User is built once, on first login,
+// and published with a CAS so two terminals always share the same object.
+class AccountLedger {
+private:
+    AccountDirectory accounts;
+    deque<atomic<User*>> users;
+public:
+    AccountLedger() = default;
+    AccountLedger(const AccountLedger &) = delete;
+    AccountLedger &operator=(const AccountLedger &) = delete;
+    ~AccountLedger() {
+        for (auto &user : users) {
+            delete user.load();
+        }
+    }
+    void reserve(size_t count) {
+        accounts.reserve(count);
+    }
+    bool addAccount(const string &name, const string &acc, int pin, int balance) {
+        if (accounts.insert(acc, name, pin, balance) == AccountDirectory::NotFound) {
+            return false;
+        }
+        users.emplace_back(nullptr);
+        return true;
+    }
+    bool loadSnapshot(const string &path) {
+        if (!accounts.loadSnapshot(path)) {
+            return false;
+        }
+        for (auto &user : users) {
+            delete user.load();
+        }
+        users.clear();
+        for (size_t i = 0; i < accounts.size(); i++) {
+            users.emplace_back(nullptr);
+        }
+        return true;
+    }
+    bool saveSnapshot(const string &path) const {
+        return accounts.saveSnapshot(path);
+    }
+    enum LoginResult {
+        OK,
+        NO_ACCOUNT,
+        WRONG_PIN
+    };
+    User *userAt(uint32_t index) {
+        User *user = users[index].load(memory_order_acquire);
+        if (!user) {
+            const AccountRecord &rec = accounts.record(index);
+            User *fresh = new User(rec.name, rec.accountNumber, rec.pin, rec.balance);
+            if (users[index].compare_exchange_strong(user, fresh, memory_order_acq_rel)) {
+                user = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        return user;
+    }
+    LoginResult login(const string &acc, int pin, User *&user) {
+        uint32_t index = accounts.find(acc);
+        if (index == AccountDirectory::NotFound) {
+            return NO_ACCOUNT;
+        }
+        const AccountRecord &rec = accounts.record(index);
+        if (rec.pin != pin) {
+            return WRONG_PIN;
+        }
+        user = userAt(index);
+        return OK;
+    }
+    // Used by journal recovery to replay a committed debit or credit.
+    bool adjustBalance(const string &acc, int delta) {
+        uint32_t index = accounts.find(acc);
+        if (index == AccountDirectory::NotFound) {
+            return false;
+        }
+        userAt(index)->addMoney(delta);
+        return true;
+    }
+    size_t size() const {
+        return accounts.size();
+    }
+    uint32_t indexOf(const string &acc) const {
+        return accounts.find(acc);
+    }
+    const AccountDirectory &directory() const {
+        return accounts;
+    }
+    const string accountAt(size_t index) const {
+        return accounts.record(index).accountNumber;
+    }
+    // Balance the account was registered or loaded with.
+    long long openingBalanceOf(size_t index) const {
+        return accounts.record(index).balance;
+    }
+    // Balance as seen by the ledger, whether or not the account has logged in.
+    long long balanceOf(size_t index) const {
+        User *user = users[index].load(memory_order_acquire);
+        return user ? user->getBalance() : accounts.record(index).balance;
+    }
+};
+
+// One money movement or cassette load, exactly as it is stored on disk.
+struct JournalRecord {
+    enum Type : uint32_t {
+        LOAD = 1,
+        DEBIT,
+        CREDIT
+    };
+    static const int MaxNotes = 8;
+    uint64_t seq;
+    uint32_t type;
+    uint32_t terminal;
+    char accountNumber[16];
+    int64_t amount;
+    int32_t notes[MaxNotes][2]; // (denomination, count change), unused slots zero
+    uint32_t checksum;          // CRC32 of every byte before it
+    uint32_t pad;
+};
+
+// Standard CRC32, eight bytes per step (slicing-by-8) so scanning a journal
+// is not bound by the checksum.
+uint32_t crc32(const void *data, size_t len) {
+    static const vector<array<uint32_t, 256>> tables = [] {
+        vector<array<uint32_t, 256>> t(8);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+        return t;
+    }();
+    uint32_t c = ~0u;
+    const unsigned char *p = (const unsigned char *)data;
+    for (; len >= 8; len -= 8, p += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= c;
+        c = tables[7][lo & 0xFF] ^ tables[6][(lo >> 8) & 0xFF] ^ tables[5][(lo >> 16) & 0xFF] ^ tables[4][lo >> 24] ^
+            tables[3][hi & 0xFF] ^ tables[2][(hi >> 8) & 0xFF] ^ tables[1][(hi >> 16) & 0xFF] ^ tables[0][hi >> 24];
+    }
+    for (; len; len--, p++) {
+        c = tables[0][(c ^ *p) & 0xFF] ^ (c >> 8);
+    }
+    return ~c;
+}
+
+// Append-only journal with group commit. Callers append a record and wait
+// until it is durable. The first waiter to find no flush in progress becomes
+// the leader: it takes every record queued so far, writes them in one call
+// and fdatasyncs once, then wakes everyone whose record made it to disk.
+class TransactionJournal {
+private:
+    int fd = -1;
+    mutex mtx;
+    condition_variable flushed;
+    vector<JournalRecord> pending;
+    uint64_t nextSeq = 0, durableSeq = 0;
+    bool flushing = false, failed = false;
+    uint64_t flushes = 0, flushedRecords = 0;
+
+    uint64_t append(JournalRecord rec) {
+        lock_guard<mutex> lock(mtx);
+        rec.seq = ++nextSeq;
+        rec.checksum = crc32(&rec, offsetof(JournalRecord, checksum));
+        pending.push_back(rec);
+        return rec.seq;
+    }
+    bool waitDurable(uint64_t seq) {
+        unique_lock<mutex> lock(mtx);
+        while (durableSeq < seq && !failed) {
+            if (flushing) {
+                flushed.wait(lock);
+                continue;
+            }
+            flushing = true;
+            vector<JournalRecord> batch;
+            batch.swap(pending);
+            lock.unlock();
+            const char *data = (const char *)batch.data();
+            size_t left = batch.size() * sizeof(JournalRecord);
+            bool ok = true;
+            while (left && ok) {
+                ssize_t n = write(fd, data, left);
+                ok = n > 0;
+                data += ok ? n : 0;
+                left -= ok ? n : 0;
+            }
+            ok = ok && fdatasync(fd) == 0;
+            lock.lock();
+            flushing = false;
+            if (ok) {
+                durableSeq = batch.back().seq;
+                flushes++;
+                flushedRecords += batch.size();
+            } else {
+                failed = true;
+            }
+            flushed.notify_all();
+        }
+        return durableSeq >= seq;
+    }
+public:
+    TransactionJournal() = default;
+    TransactionJournal(const TransactionJournal &) = delete;
+    TransactionJournal &operator=(const TransactionJournal &) = delete;
+    ~TransactionJournal() {
+        close();
+    }
+    // Continues the sequence after `lastSeq`, the last record recovery accepted.
+    bool open(const string &path, uint64_t lastSeq = 0) {
+        close();
+        fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+        nextSeq = durableSeq = lastSeq;
+        failed = false;
+        return fd >= 0;
+    }
+    void close() {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    // Returns once the record is on disk; false if the journal could not write it.
+    bool commit(JournalRecord::Type type, uint32_t terminal, const string &acc, int64_t amount, const map<int, int> &notes, int noteSign) {
+        if (notes.size() > JournalRecord::MaxNotes) {
+            return false;
+        }
+        JournalRecord rec{};
+        rec.type = type;
+        rec.terminal = terminal;
+        strncpy(rec.accountNumber, acc.c_str(), sizeof(rec.accountNumber) - 1);
+        rec.amount = amount;
+        int i = 0;
+        for (auto &x : notes) {
+            rec.notes[i][0] = x.first;
+            rec.notes[i][1] = noteSign * x.second;
+            i++;
+        }
+        return waitDurable(append(rec));
+    }
+    double averageBatch() {
+        lock_guard<mutex> lock(mtx);
+        return flushes ? (double)flushedRecords / flushes : 0;
+    }
+    enum Recovery {
+        CLEAN,   // every record replayed; a torn final record was cut off
+        DAMAGED, // a bad record sits before later data; the file is left as is
+        FAILED   // the file could not be read or cut
+    };
+    // Calls apply(record) for each intact record in order and sets lastSeq to
+    // the last one. Only a short final record, a write the crash interrupted,
+    // is cut off; a record that fails its checksum or sequence check stops
+    // the replay and the journal is reported DAMAGED without touching it.
+    template <typename Apply>
+    static Recovery replay(const string &path, uint64_t &lastSeq, Apply &&apply) {
+        lastSeq = 0;
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f) {
+            return errno == ENOENT ? CLEAN : FAILED;
+        }
+        off_t good = 0;
+        JournalRecord rec;
+        size_t n;
+        while ((n = fread(&rec, 1, sizeof(rec), f)) == sizeof(rec)) {
+            if (rec.checksum != crc32(&rec, offsetof(JournalRecord, checksum)) || rec.seq != lastSeq + 1) {
+                fclose(f);
+                return DAMAGED;
+            }
+            apply(rec);
+            lastSeq = rec.seq;
+            good += sizeof(rec);
+        }
+        bool readError = ferror(f);
+        fclose(f);
+        if (readError) {
+            return FAILED;
+        }
+        if (n == 0) {
+            return CLEAN;
+        }
+        return truncate(path.c_str(), good) == 0 ? CLEAN : FAILED;
+    }
+};
+
+// End-of-day check of a journal against what operations counted. The journal
+// is read once, front to back, in large blocks; state is one running total per
+// (terminal, denomination) and one per account, so memory does not grow with
+// the number of records.
+class JournalReconciler {
+public:
+    struct CashMismatch {
+        uint32_t terminal;
+        int denomination;
+        long long expected, counted;
+    };
+    struct AccountMismatch {
+        string account;
+        long long expected, actual;
+    };
+    struct Report {
+        uint64_t records = 0, bytes = 0, unknownAccountRecords = 0;
+        bool intact = true; // false if a corrupt record or sequence gap stopped the scan
+        vector<CashMismatch> cash;
+        vector<AccountMismatch> accounts;
+    };
+private:
+    const AccountLedger &ledger;
+    vector<int> denominations;             // column order for expectedNotes
+    vector<vector<long long>> expectedNotes; // [terminal][denomination column]
+    vector<long long> netMovement;         // [account index]
+
+    size_t column(int denomination) {
+        for (size_t i = 0; i < denominations.size(); i++) {
+            if (denominations[i] == denomination) {
+                return i;
+            }
+        }
+        denominations.push_back(denomination);
+        for (auto &row : expectedNotes) {
+            row.push_back(0);
+        }
+        return denominations.size() - 1;
+    }
+    void apply(const JournalRecord &rec, uint64_t accountHash, Report &report) {
+        if (rec.terminal >= expectedNotes.size()) {
+            expectedNotes.resize(rec.terminal + 1, vector<long long>(denominations.size(), 0));
+        }
+        for (auto &note : rec.notes) {
+            if (note[0]) {
+                size_t c = column(note[0]);
+                expectedNotes[rec.terminal][c] += note[1];
+            }
+        }
+        if (rec.type == JournalRecord::LOAD) {
+            return;
+        }
+        uint32_t index = ledger.directory().find(rec.accountNumber, strnlen(rec.accountNumber, sizeof(rec.accountNumber)), accountHash);
+        if (index == AccountDirectory::NotFound) {
+            report.unknownAccountRecords++;
+            return;
+        }
+        netMovement[index] += rec.amount;
+    }
+public:
+    explicit JournalReconciler(const AccountLedger &l) : ledger(l) {}
+
+    // countedNotes[terminal] is the physical cassette count per denomination.
+    Report run(const string &path, const vector<map<int, int>> &countedNotes) {
+        Report report;
+        denominations.clear();
+        expectedNotes.assign(countedNotes.size(), {});
+        netMovement.assign(ledger.size(), 0);
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            report.intact = false;
+            return report;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        const size_t blockRecords = (4 << 20) / sizeof(JournalRecord);
+        vector<JournalRecord> block(blockRecords);
+        vector<uint64_t> hashes(blockRecords);
+        size_t buffered = 0; // bytes of a partial record carried into the next read
+        uint64_t lastSeq = 0;
+        while (report.intact) {
+            ssize_t n = read(fd, (char *)block.data() + buffered, blockRecords * sizeof(JournalRecord) - buffered);
+            if (n <= 0) {
+                report.intact = buffered == 0 && n == 0;
+                break;
+            }
+            report.bytes += n;
+            buffered += n;
+            size_t whole = buffered / sizeof(JournalRecord), valid = 0;
+            for (; valid < whole; valid++) {
+                const JournalRecord &rec = block[valid];
+                if (rec.checksum != crc32(&rec, offsetof(JournalRecord, checksum)) || rec.seq != lastSeq + 1) {
+                    report.intact = false;
+                    break;
+                }
+                lastSeq = rec.seq;
+                hashes[valid] = AccountDirectory::hashOf(rec.accountNumber, strnlen(rec.accountNumber, sizeof(rec.accountNumber)));
+            }
+            // Account lookups are random; keep several in flight instead of missing cache on each.
+            const AccountDirectory &dir = ledger.directory();
+            for (size_t i = 0; i < valid; i++) {
+                if (i + 16 < valid) {
+                    dir.prefetchSlot(hashes[i + 16]);
+                }
+                if (i + 8 < valid) {
+                    dir.prefetchRecord(hashes[i + 8]);
+                }
+                apply(block[i], hashes[i], report);
+            }
+            report.records += valid;
+            buffered -= whole * sizeof(JournalRecord);
+            memmove(block.data(), (char *)block.data() + whole * sizeof(JournalRecord), buffered);
+        }
+        close(fd);
+
+        for (uint32_t t = 0; t < expectedNotes.size(); t++) {
+            for (size_t c = 0; c < denominations.size(); c++) {
+                long long counted = 0;
+                if (t < countedNotes.size()) {
+                    auto it = countedNotes[t].find(denominations[c]);
+                    counted = it == countedNotes[t].end() ? 0 : it->second;
+                }
+                if (counted != expectedNotes[t][c]) {
+                    report.cash.push_back({t, denominations[c], expectedNotes[t][c], counted});
+                }
+            }
+        }
+        for (size_t i = 0; i < netMovement.size(); i++) {
+            long long expected = ledger.openingBalanceOf(i) + netMovement[i];
+            long long actual = ledger.balanceOf(i);
+            if (expected != actual) {
+                report.accounts.push_back({ledger.accountAt(i), expected, actual});
+            }
+        }
+        return report;
+    }
 };
 
 class IATMMachine {
 public:
-    virtual void enterCard(string acc, int pin) = 0;
-    virtual void withdrawMoney(int amount) = 0;
-    virtual void depositMoney(int amount) = 0;
+    virtual bool enterCard(string acc, int pin) = 0;
+    virtual bool withdrawMoney(int amount) = 0;
+    virtual bool depositMoney(int amount) = 0;
     virtual void checkBalance() = 0;
 };
 
@@ -101,85 +873,528 @@ private:
     };
     State state;
     ICash *icash;
-    vector<User*> userDetails;
+    AccountLedger *ledger;
     User *currentUser;
+    ostream *log;
+    TransactionJournal *journal = nullptr;
+    uint32_t terminalId = 0;
     static ATMMachine *instance;
 
-    ATMMachine(ICash *c) : state(IDLE), icash(c), currentUser(nullptr) {}
+    ATMMachine(ICash *c, AccountLedger *l, ostream *out = &cout) : state(IDLE), icash(c), ledger(l), currentUser(nullptr), log(out) {}
+    friend class ATMNetwork;
 
 public:
     static ATMMachine* getInstance(ICash *c) {
         if (!instance) {
-            instance = new ATMMachine(c);
+            instance = new ATMMachine(c, new AccountLedger());
         }
         return instance;
     }
-    void addUser(string name, string acc, int pin, int balance) {
-        userDetails.push_back(new User(name, acc, pin, balance));
+    bool addUser(string name, string acc, int pin, int balance) {
+        if (!AccountDirectory::fits(acc, name)) {
+            *log << "Cannot add account " << acc << ": account number or name too long.\n";
+            return false;
+        }
+        if (!ledger->addAccount(name, acc, pin, balance)) {
+            *log << "Cannot add account " << acc << ": it already exists.\n";
+            return false;
+        }
+        return true;
     }
-    void enterCard(string acc, int pin) override {
-        for (auto &x : userDetails) {
-            if (x->getAcc() == acc) {
-                if (x->getPin() == pin) {
-                    state = ACTIVE;
-                    currentUser = x;
-                    cout << "Welcome " << acc << "! You are now logged in.\n";
-                    return;
-                } else {
-                    cout << "Wrong PIN! Try again.\n";
-                    return;
-                }
-            }
+    bool loadAccounts(const string &snapshotPath) {
+        return ledger->loadSnapshot(snapshotPath);
+    }
+    bool saveAccounts(const string &snapshotPath) const {
+        return ledger->saveSnapshot(snapshotPath);
+    }
+    bool enterCard(string acc, int pin) override {
+        User *user = nullptr;
+        switch (ledger->login(acc, pin, user)) {
+        case AccountLedger::NO_ACCOUNT:
+            *log << "Account not found!\n";
+            return false;
+        case AccountLedger::WRONG_PIN:
+            *log << "Wrong PIN! Try again.\n";
+            return false;
+        case AccountLedger::OK:
+            break;
         }
-        cout << "Account not found!\n";
+        state = ACTIVE;
+        currentUser = user;
+        *log << "Welcome " << acc << "! You are now logged in.\n";
+        return true;
     }
-    void withdrawMoney(int amount) override {
+    bool withdrawMoney(int amount) override {
         if (state != ACTIVE || currentUser == nullptr) {
-            cout << "Please authenticate first.\n";
-            return;
+            *log << "Please authenticate first.\n";
+            return false;
         }
         if (!icash->canProcess(amount)) {
-            cout << "ATM does not have enough cash.\n";
-            return;
+            *log << "ATM does not have enough cash.\n";
+            return false;
         }
         if (!currentUser->withdrawMoney(amount)) {
-            cout << "Insufficient balance in your account.\n";
-            return;
+            *log << "Insufficient balance in your account.\n";
+            return false;
+        }
+        // No cash leaves the cassette until the debit is durable.
+        if (journal && !journal->commit(JournalRecord::DEBIT, terminalId, currentUser->getAcc(), -amount, icash->getLastPlan(), -1)) {
+            currentUser->addMoney(amount);
+            *log << "Transaction could not be recorded.\n";
+            return false;
         }
         icash->performTransaction();
-        cout << "Withdrawn: $" << amount << "\n";
+        *log << "Withdrawn: $" << amount << "\n";
+        return true;
     }
-    void depositMoney(int amount) override {
+    bool depositMoney(int amount) override {
         if (state != ACTIVE || currentUser == nullptr) {
-            cout << "Please authenticate first.\n";
-            return;
+            *log << "Please authenticate first.\n";
+            return false;
+        }
+        if (journal && !journal->commit(JournalRecord::CREDIT, terminalId, currentUser->getAcc(), amount, {{500, amount / 500}}, 1)) {
+            *log << "Transaction could not be recorded.\n";
+            return false;
         }
         currentUser->addMoney(amount);
         icash->addMoney(500, amount / 500); 
-        cout << "Deposited: $" << amount << "\n";
+        *log << "Deposited: $" << amount << "\n";
+        return true;
     }
     void checkBalance() override {
         if (state != ACTIVE || currentUser == nullptr) {
-            cout << "Please authenticate first.\n";
+            *log << "Please authenticate first.\n";
             return;
         }
-        cout << "Your balance: $" << currentUser->getBalance() << "\n";
+        *log << "Your balance: $" << currentUser->getBalance() << "\n";
     }
     void logout() {
         if (state == ACTIVE) {
-            cout << "Goodbye " << currentUser->getName() << "!\n";
+            *log << "Goodbye " << currentUser->getName() << "!\n";
             currentUser = nullptr;
             state = IDLE;
         } else {
-            cout << "No user logged in.\n";
+            *log << "No user logged in.\n";
+        }
+    }
+};
+
+// Many terminals in one process. Each terminal owns its cassette and session
+// state and is driven by one thread at a time; all of them share one ledger.
+class ATMNetwork {
+private:
+    AccountLedger ledger;
+    TransactionJournal journal;
+    bool journaling = false;
+    vector<unique_ptr<Cash>> cassettes;
+    vector<unique_ptr<ATMMachine>> terminals;
+
+    ATMMachine *createTerminal(const map<int, int> &notes, ostream *log) {
+        cassettes.emplace_back(new Cash());
+        for (auto &x : notes) {
+            cassettes.back()->addMoney(x.first, x.second);
+        }
+        terminals.emplace_back(new ATMMachine(cassettes.back().get(), &ledger, log));
+        terminals.back()->terminalId = terminals.size() - 1;
+        if (journaling) {
+            terminals.back()->journal = &journal;
         }
+        return terminals.back().get();
+    }
+public:
+    AccountLedger &getLedger() {
+        return ledger;
+    }
+    // Replays an existing journal into the ledger and rebuilds every terminal's
+    // cassette from it, then keeps appending to the same file. Accounts must be
+    // registered first; call before adding terminals. A damaged journal, or one
+    // naming accounts the ledger does not have, is replayed up to the problem
+    // but not appended to: terminals then run unjournaled and this returns
+    // false until the file is repaired.
+    bool openJournal(const string &path, ostream *log = &cout) {
+        vector<map<int, int>> recovered;
+        uint64_t lastSeq = 0;
+        size_t unknownAccounts = 0;
+        TransactionJournal::Recovery state = TransactionJournal::replay(path, lastSeq, [&](const JournalRecord &rec) {
+            if (rec.terminal >= recovered.size()) {
+                recovered.resize(rec.terminal + 1);
+            }
+            for (auto &note : rec.notes) {
+                if (note[0]) {
+                    recovered[rec.terminal][note[0]] += note[1];
+                }
+            }
+            if (rec.type != JournalRecord::LOAD && !ledger.adjustBalance(rec.accountNumber, (int)rec.amount)) {
+                unknownAccounts++;
+            }
+        });
+        if (state == TransactionJournal::DAMAGED) {
+            *log << "Journal " << path << " is damaged after record " << lastSeq << "; not resuming it.\n";
+        } else if (state == TransactionJournal::FAILED) {
+            *log << "Journal " << path << " could not be recovered.\n";
+        }
+        if (unknownAccounts) {
+            *log << "Journal " << path << " has " << unknownAccounts << " records for unknown accounts; not resuming it.\n";
+        }
+        for (auto &notes : recovered) {
+            createTerminal(notes, log);
+        }
+        journaling = state == TransactionJournal::CLEAN && !unknownAccounts && journal.open(path, lastSeq);
+        for (auto &terminal : terminals) {
+            terminal->journal = journaling ? &journal : nullptr;
+        }
+        return journaling;
+    }
+    ATMMachine *addTerminal(const map<int, int> &notes, ostream *log = &cout) {
+        if (journaling && !journal.commit(JournalRecord::LOAD, terminals.size(), "", 0, notes, 1)) {
+            return nullptr;
+        }
+        return createTerminal(notes, log);
+    }
+    size_t terminalCount() const {
+        return terminals.size();
+    }
+    ATMMachine *getTerminal(size_t terminal) {
+        return terminals[terminal].get();
+    }
+    TransactionJournal &getJournal() {
+        return journal;
+    }
+    Cash *getCassette(size_t terminal) {
+        return cassettes[terminal].get();
     }
 };
 
 ATMMachine* ATMMachine::instance = nullptr;
 Cash* Cash::instance = nullptr;
 
-int main() {
+// The smallest-note-first greedy canProcess used before DispensePlanner.
+bool greedyPlan(const map<int, int> &cassette, int amount, map<int, int> &out) {
+    out.clear();
+    for (auto &x : cassette) {
+        int count = x.second;
+        while (amount >= x.first && count) {
+            count--;
+            amount -= x.first;
+            out[x.first]++;
+        }
+    }
+    return amount == 0;
+}
+
+void benchmarkDispensePlanning() {
+    map<int, int> cassette{{100, 40}, {200, 30}, {500, 60}, {2000, 25}};
+    vector<int> amounts;
+    mt19937 gen(3);
+    for (int i = 0; i < 100000; i++) {
+        amounts.push_back(100 * (1 + gen() % 150));
+    }
+    auto ms = [](chrono::steady_clock::time_point from) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - from).count();
+    };
+    map<int, int> out;
+    int greedyOk = 0, plannerOk = 0, cachedOk = 0;
+
+    auto t = chrono::steady_clock::now();
+    for (int a : amounts) {
+        greedyOk += greedyPlan(cassette, a, out);
+    }
+    double greedyMs = ms(t);
+
+    DispensePlanner planner;
+    t = chrono::steady_clock::now();
+    for (int a : amounts) {
+        plannerOk += planner.plan(cassette, a, out);
+    }
+    double plannerMs = ms(t);
+
+    Cash *cash = Cash::getInstance();
+    for (auto &x : cassette) {
+        cash->addMoney(x.first, x.second);
+    }
+    t = chrono::steady_clock::now();
+    for (int a : amounts) {
+        cachedOk += cash->canProcess(a);
+    }
+    double cachedMs = ms(t);
+
+    cout << "greedy:  " << greedyMs * 1e6 / amounts.size() << " ns/plan, " << greedyOk << " payable\n";
+    cout << "planner: " << plannerMs * 1e6 / amounts.size() << " ns/plan, " << plannerOk << " payable\n";
+    cout << "cached:  " << cachedMs * 1e6 / amounts.size() << " ns/plan, " << cachedOk << " payable\n";
+}
+
+void benchmarkAccountDirectory() {
+    const int accounts = 10000000, lookups = 1000000;
+    const string path = "/tmp/atm_accounts.snapshot";
+    auto ms = [](chrono::steady_clock::time_point from) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - from).count();
+    };
+    auto accountNumber = [](int i) {
+        return to_string(1000000000LL + i * 7919LL % 1000000000LL);
+    };
+    {
+        AccountDirectory built;
+        built.reserve(accounts);
+        auto t = chrono::steady_clock::now();
+        for (int i = 0; i < accounts; i++) {
+            built.insert(accountNumber(i), "Customer", 1000 + i % 9000, 5000);
+        }
+        cout << "build " << accounts << " accounts: " << ms(t) << " ms\n";
+        if (!built.saveSnapshot(path)) {
+            cout << "could not write " << path << "\n";
+            return;
+        }
+    }
+    AccountDirectory directory;
+    auto t = chrono::steady_clock::now();
+    bool loaded = directory.loadSnapshot(path);
+    cout << "load snapshot: " << ms(t) << " ms (" << (loaded ? "ok" : "failed") << ", " << directory.size() << " accounts)\n";
+
+    mt19937 gen(9);
+    vector<string> keys;
+    for (int i = 0; i < lookups; i++) {
+        keys.push_back(i % 10 ? accountNumber(gen() % accounts) : "missing" + to_string(i));
+    }
+    long long hits = 0;
+    t = chrono::steady_clock::now();
+    for (auto &key : keys) {
+        hits += directory.find(key) != AccountDirectory::NotFound;
+    }
+    cout << "lookup (cold pages): " << ms(t) * 1e6 / lookups << " ns, " << hits << " hits\n";
+    hits = 0;
+    t = chrono::steady_clock::now();
+    for (auto &key : keys) {
+        hits += directory.find(key) != AccountDirectory::NotFound;
+    }
+    cout << "lookup (warm): " << ms(t) * 1e6 / lookups << " ns, " << hits << " hits\n";
+
+    // The linear vector<User*> scan enterCard used to do, on a few keys.
+    vector<User*> userDetails;
+    for (size_t i = 0; i < directory.size(); i++) {
+        auto &rec = directory.record(i);
+        userDetails.push_back(new User(rec.name, rec.accountNumber, rec.pin, rec.balance));
+    }
+    t = chrono::steady_clock::now();
+    for (int k = 0; k < 10; k++) {
+        for (auto &x : userDetails) {
+            if (x->getAcc() == keys[k]) {
+                hits++;
+                break;
+            }
+        }
+    }
+    cout << "linear scan: " << ms(t) / 10 << " ms/lookup\n";
+    for (auto *u : userDetails) {
+        delete u;
+    }
+    remove(path.c_str());
+}
+
+void benchmarkATMNetwork() {
+    const int accounts = 100000, sessionsPerTerminal = 200000, hotAccounts = 64, startBalance = 2000;
+    const map<int, int> notes{{100, 1000000}, {200, 1000000}, {500, 1000000}};
+    ostream quiet(nullptr);
+    int maxTerminals = max(4u, thread::hardware_concurrency());
+    for (int terminals = 1; terminals <= maxTerminals; terminals *= 2) {
+        ATMNetwork network;
+        network.getLedger().reserve(accounts);
+        for (int i = 0; i < accounts; i++) {
+            network.getLedger().addAccount("Customer", to_string(100000 + i), 1234, startBalance);
+        }
+        vector<ATMMachine*> atms;
+        vector<long long> cashBefore;
+        for (int t = 0; t < terminals; t++) {
+            atms.push_back(network.addTerminal(notes, &quiet));
+            cashBefore.push_back(network.getCassette(t)->getTotalCash());
+        }
+        vector<long long> withdrawn(terminals), deposited(terminals);
+        auto session = [&](int t) {
+            mt19937 rng(t + 1);
+            for (int i = 0; i < sessionsPerTerminal; i++) {
+                // Half the sessions hit a small hot set so terminals collide on accounts.
+                int acc = rng() % 2 ? rng() % hotAccounts : rng() % accounts;
+                atms[t]->enterCard(to_string(100000 + acc), 1234);
+                int amount = 100 * (1 + rng() % 10);
+                if (rng() % 4 == 0) {
+                    deposited[t] += atms[t]->depositMoney(500) ? 500 : 0;
+                } else if (atms[t]->withdrawMoney(amount)) {
+                    withdrawn[t] += amount;
+                }
+                atms[t]->logout();
+            }
+        };
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (int t = 0; t < terminals; t++) {
+            pool.emplace_back(session, t);
+        }
+        for (auto &th : pool) {
+            th.join();
+        }
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // Money is conserved, no balance went negative and every cassette paid out exactly what it recorded.
+        long long ledgerTotal = 0, flows = 0;
+        bool overdrawn = false, cassettesMatch = true;
+        for (int i = 0; i < accounts; i++) {
+            long long b = network.getLedger().balanceOf(i);
+            overdrawn |= b < 0;
+            ledgerTotal += b;
+        }
+        for (int t = 0; t < terminals; t++) {
+            flows += deposited[t] - withdrawn[t];
+            cassettesMatch &= network.getCassette(t)->getTotalCash() == cashBefore[t] + deposited[t] - withdrawn[t];
+        }
+        bool conserved = ledgerTotal == (long long)accounts * startBalance + flows;
+        cout << terminals << " terminals: " << (long long)(terminals * sessionsPerTerminal / secs) << " sessions/s, "
+             << (conserved && !overdrawn && cassettesMatch ? "ledger consistent" : "LEDGER INCONSISTENT") << "\n";
+    }
+}
+
+void benchmarkJournal() {
+    const int accounts = 10000, withdrawalsPerTerminal = 2000, startBalance = 1000000;
+    const map<int, int> notes{{100, 1000000}, {200, 1000000}, {500, 1000000}};
+    const string path = "/tmp/atm_journal.bin";
+    ostream quiet(nullptr);
+    auto registerAccounts = [&](ATMNetwork &network) {
+        network.getLedger().reserve(accounts);
+        for (int i = 0; i < accounts; i++) {
+            network.getLedger().addAccount("Customer", to_string(100000 + i), 1234, startBalance);
+        }
+    };
+    int maxTerminals = max(8u, thread::hardware_concurrency());
+    for (int terminals = 1; terminals <= maxTerminals; terminals *= 2) {
+        remove(path.c_str());
+        ATMNetwork network;
+        registerAccounts(network);
+        network.openJournal(path, &quiet);
+        for (int t = 0; t < terminals; t++) {
+            network.addTerminal(notes, &quiet);
+        }
+        vector<double> latencyMicros(terminals);
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (int t = 0; t < terminals; t++) {
+            pool.emplace_back([&, t]() {
+                mt19937 rng(t + 1);
+                ATMMachine *atm = network.getTerminal(t);
+                for (int i = 0; i < withdrawalsPerTerminal; i++) {
+                    atm->enterCard(to_string(100000 + rng() % accounts), 1234);
+                    auto before = chrono::steady_clock::now();
+                    atm->withdrawMoney(100 * (1 + rng() % 10));
+                    latencyMicros[t] += chrono::duration<double, micro>(chrono::steady_clock::now() - before).count();
+                    atm->logout();
+                }
+            });
+        }
+        for (auto &th : pool) {
+            th.join();
+        }
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double totalMicros = accumulate(latencyMicros.begin(), latencyMicros.end(), 0.0);
+        cout << terminals << " terminals: " << (long long)(terminals * withdrawalsPerTerminal / secs) << " tx/s, "
+             << totalMicros / (terminals * withdrawalsPerTerminal) << " us/commit, "
+             << network.getJournal().averageBatch() << " records/fsync\n";
+
+        if (terminals * 2 > maxTerminals) {
+            // Rebuild from the journal alone and compare with the live state.
+            ATMNetwork recovered;
+            registerAccounts(recovered);
+            auto t0 = chrono::steady_clock::now();
+            recovered.openJournal(path, &quiet);
+            double recoverMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            bool same = recovered.terminalCount() == network.terminalCount();
+            for (int i = 0; i < accounts && same; i++) {
+                same = recovered.getLedger().balanceOf(i) == network.getLedger().balanceOf(i);
+            }
+            for (int t = 0; t < terminals && same; t++) {
+                same = recovered.getCassette(t)->getTotalCash() == network.getCassette(t)->getTotalCash();
+            }
+            cout << "recovery: " << recoverMs << " ms, " << (same ? "balances and cassettes match" : "MISMATCH") << "\n";
+        }
+    }
+    remove(path.c_str());
+}
+
+void benchmarkReconciliation() {
+    const int accounts = 1000000, terminals = 200;
+    const uint64_t records = 10000000;
+    const string path = "/tmp/atm_reconcile.bin";
+    AccountLedger ledger;
+    ledger.reserve(accounts);
+    for (int i = 0; i < accounts; i++) {
+        ledger.addAccount("Customer", to_string(100000000 + i), 1234, 1000000);
+    }
+
+    // Synthetic day of withdrawals, written straight to disk without fsyncs.
+    vector<map<int, int>> cassettes(terminals);
+    vector<long long> net(accounts, 0);
+    FILE *f = fopen(path.c_str(), "wb");
+    mt19937 rng(21);
+    vector<JournalRecord> chunk;
+    for (uint64_t seq = 1; seq <= records; seq++) {
+        JournalRecord rec{};
+        rec.seq = seq;
+        rec.terminal = rng() % terminals;
+        if (seq <= (uint64_t)terminals) {
+            rec.type = JournalRecord::LOAD;
+            rec.terminal = seq - 1;
+            rec.notes[0][0] = 100, rec.notes[0][1] = 10000000;
+            rec.notes[1][0] = 500, rec.notes[1][1] = 10000000;
+        } else {
+            int acc = rng() % accounts, hundreds = 1 + rng() % 4, fives = rng() % 3;
+            rec.type = JournalRecord::DEBIT;
+            strcpy(rec.accountNumber, to_string(100000000 + acc).c_str());
+            rec.amount = -(100 * hundreds + 500 * fives);
+            rec.notes[0][0] = 100, rec.notes[0][1] = -hundreds;
+            rec.notes[1][0] = 500, rec.notes[1][1] = -fives;
+            net[acc] += rec.amount;
+        }
+        for (auto &note : rec.notes) {
+            if (note[0]) {
+                cassettes[rec.terminal][note[0]] += note[1];
+            }
+        }
+        rec.checksum = crc32(&rec, offsetof(JournalRecord, checksum));
+        chunk.push_back(rec);
+        if (chunk.size() == 65536 || seq == records) {
+            fwrite(chunk.data(), sizeof(JournalRecord), chunk.size(), f);
+            chunk.clear();
+        }
+    }
+    fclose(f);
+    for (int i = 0; i < accounts; i++) {
+        ledger.adjustBalance(to_string(100000000 + i), net[i]);
+    }
+    // Plant one cash shortage and one ledger discrepancy for the job to find.
+    cassettes[7][500] -= 2;
+    ledger.adjustBalance(to_string(100000000 + 42), 100);
+
+    JournalReconciler reconciler(ledger);
+    auto t0 = chrono::steady_clock::now();
+    auto report = reconciler.run(path, cassettes);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    cout << "reconcile " << report.records << " records: " << secs << " s, " << report.bytes / secs / (1 << 20)
+         << " MB/s, " << report.cash.size() << " cash and " << report.accounts.size() << " account mismatches"
+         << (report.intact ? "" : ", journal damaged") << "\n";
+    for (auto &m : report.cash) {
+        cout << "  terminal " << m.terminal << " note " << m.denomination << ": expected " << m.expected << ", counted " << m.counted << "\n";
+    }
+    for (auto &m : report.accounts) {
+        cout << "  account " << m.account << ": expected " << m.expected << ", ledger " << m.actual << "\n";
+    }
+    remove(path.c_str());
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkReconciliation();
+        benchmarkJournal();
+        benchmarkATMNetwork();
+        benchmarkAccountDirectory();
+        benchmarkDispensePlanning();
+        return 0;
+    }
     Cash* atmCash = Cash::getInstance();
     atmCash->addMoney(500, 10); 
     atmCash->addMoney(200, 10); 
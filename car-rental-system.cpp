@@ -1,16 +1,29 @@
 #include <bits/stdc++.h>
 #include <mutex>
+#include <shared_mutex>
 using namespace std;
 
+// Planar position in km east/north of the metro reference point.
+struct Location
+{
+    double x = 0, y = 0;
+    double distanceTo(const Location &o) const { return hypot(x - o.x, y - o.y); }
+};
+
 class Car
 {
 private:
     string maker, model, year;
     int rentalPricePerDay;
+    Location location;
+    atomic<int> carId{-1}; // read by bookings without the catalog lock
 
 public:
-    Car(string c, string m, string y, int rent) : maker(c), model(m), year(y), rentalPricePerDay(rent) {}
+    Car(string c, string m, string y, int rent, Location loc = {}) : maker(c), model(m), year(y), rentalPricePerDay(rent), location(loc) {}
     int getPrice() const { return rentalPricePerDay; }
+    const Location &getLocation() const { return location; }
+    int getId() const { return carId.load(memory_order_acquire); }
+    void setId(int id) { carId.store(id, memory_order_release); }
 };
 
 class User
@@ -66,6 +79,442 @@ public:
     Reservation(int id, shared_ptr<User> u, shared_ptr<Car> c, string st, string e)
         : uid(id), user(u), car(c), start(st), end(e) {}
     shared_ptr<Car> getCar() const { return car; }
+    const string &getStart() const { return start; }
+    const string &getEnd() const { return end; }
+};
+
+// "YYYY-MM-DD" -> days since 1970-01-01, so reservation dates compare as ints.
+int toDayNumber(const string &date)
+{
+    int y = stoi(date.substr(0, 4)), m = stoi(date.substr(5, 2)), d = stoi(date.substr(8, 2));
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Inverse of toDayNumber.
+string toDateString(int dayNumber)
+{
+    int z = dayNumber + 719468, era = (z >= 0 ? z : z - 146096) / 146097, doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100), mp = (5 * doy + 2) / 153;
+    int d = doy - (153 * mp + 2) / 5 + 1, m = mp < 10 ? mp + 3 : mp - 9, y = yoe + era * 400 + (m <= 2);
+    char text[32];
+    snprintf(text, sizeof(text), "%04d-%02d-%02d", y, m, d);
+    return text;
+}
+
+// Today's day number (UTC).
+int today()
+{
+    return (int)(chrono::duration_cast<chrono::hours>(chrono::system_clock::now().time_since_epoch()).count() / 24);
+}
+
+// Date-range bookings per car, without a global lock. Each car has a booked-day
+// bitmap and a version counter that is odd while a writer holds the car.
+// Reservations validate the bitmap optimistically and commit with a CAS on the
+// version; searches read the bitmap seqlock-style and retry if it moved.
+//
+// The bitmap is a ring over a HorizonDays window starting at firstDay: day d
+// lives in bit d % HorizonDays. slideTo() moves the window forward, clearing
+// the bits of the days that fell behind so they can serve the new days at the
+// far end.
+//
+// A calendar can also record which car currently holds its id (assign), so a
+// booking made with a stale id is refused under the same per-car version lock
+// instead of behind a fleet-wide one.
+class ReservationEngine
+{
+public:
+    static const int HorizonDays = 1024;
+private:
+    static const int Words = HorizonDays / 64;
+    static const int ChunkBits = 10, ChunkSize = 1 << ChunkBits, MaxChunks = 4096;
+    struct alignas(64) CarCalendar
+    {
+        atomic<uint64_t> version{0};
+        atomic<uint64_t> bookedDays[Words] = {};
+        atomic<const void *> owner{nullptr};
+    };
+    // The window is [firstDay, endDay). A slide raises firstDay first and
+    // endDay only once the recycled bits are clear, so no booking can land in
+    // a bit while it is being handed to a new day.
+    atomic<int> firstDay, endDay;
+    mutex slideMutex;
+    // Calendars are allocated lazily in fixed chunks so they never move under readers.
+    atomic<CarCalendar *> chunks[MaxChunks];
+
+    CarCalendar *calendar(int carId, bool create) const
+    {
+        auto &slot = const_cast<atomic<CarCalendar *> &>(chunks[carId >> ChunkBits]);
+        CarCalendar *chunk = slot.load(memory_order_acquire);
+        if (!chunk && create)
+        {
+            CarCalendar *fresh = new CarCalendar[ChunkSize];
+            if (slot.compare_exchange_strong(chunk, fresh, memory_order_acq_rel))
+                chunk = fresh;
+            else
+                delete[] fresh;
+        }
+        return chunk ? &chunk[carId & (ChunkSize - 1)] : nullptr;
+    }
+    static uint64_t wordMask(int w, int from, int to)
+    {
+        int lo = max(from, w * 64) - w * 64, hi = min(to, w * 64 + 64) - w * 64;
+        uint64_t upTo = hi == 64 ? ~0ULL : (1ULL << hi) - 1;
+        return upTo & ~((1ULL << lo) - 1);
+    }
+    // Calls f(word, mask) for the bits of days [startDay, endDay), which may
+    // wrap around the end of the ring.
+    template <typename F>
+    static void forEachWord(int startDay, int endDay, F &&f)
+    {
+        int from = startDay % HorizonDays, to = from + (endDay - startDay);
+        for (int w = from / 64; w <= (min(to, HorizonDays) - 1) / 64; w++)
+            f(w, wordMask(w, from, min(to, HorizonDays)));
+        for (int w = 0; to > HorizonDays && w <= (to - HorizonDays - 1) / 64; w++)
+            f(w, wordMask(w, 0, to - HorizonDays));
+    }
+    static bool overlaps(const CarCalendar &c, int startDay, int endDay)
+    {
+        bool busy = false;
+        forEachWord(startDay, endDay, [&](int w, uint64_t mask)
+                    { busy |= (c.bookedDays[w].load(memory_order_relaxed) & mask) != 0; });
+        return busy;
+    }
+    static uint64_t lockCalendar(CarCalendar &c)
+    {
+        uint64_t seen = c.version.load(memory_order_relaxed);
+        while ((seen & 1) || !c.version.compare_exchange_weak(seen, seen + 1, memory_order_acquire, memory_order_relaxed))
+            seen = c.version.load(memory_order_relaxed);
+        return seen;
+    }
+    static bool validCar(int carId) { return carId >= 0 && carId < MaxChunks * ChunkSize; }
+public:
+    explicit ReservationEngine(int firstDay) : firstDay(firstDay), endDay(firstDay + HorizonDays)
+    {
+        for (auto &chunk : chunks)
+            chunk.store(nullptr, memory_order_relaxed);
+    }
+    ~ReservationEngine()
+    {
+        for (auto &chunk : chunks)
+            delete[] chunk.load(memory_order_relaxed);
+    }
+    ReservationEngine(const ReservationEngine &) = delete;
+    ReservationEngine &operator=(const ReservationEngine &) = delete;
+
+    // Whether [startDay, endDay) is a non-empty range inside the bookable window.
+    bool inWindow(int startDay, int endDay) const
+    {
+        // endDay first: firstDay is raised before endDay, so this pair never
+        // spans more than HorizonDays.
+        int last = this->endDay.load(memory_order_acquire);
+        return startDay < endDay && endDay <= last && startDay >= firstDay.load(memory_order_acquire);
+    }
+    // Moves the window to start at `day`, dropping bookings for earlier days.
+    // Cheap when the window is already there, so callers can slide on every request.
+    void slideTo(int day)
+    {
+        if (day <= firstDay.load(memory_order_relaxed))
+            return;
+        lock_guard<mutex> guard(slideMutex);
+        int old = firstDay.load(memory_order_relaxed);
+        if (day <= old)
+            return;
+        firstDay.store(day, memory_order_seq_cst);
+        int dropFrom = max(old, day - HorizonDays);
+        for (auto &chunk : chunks)
+        {
+            CarCalendar *cars = chunk.load(memory_order_acquire);
+            for (int i = 0; cars && i < ChunkSize; i++)
+            {
+                CarCalendar &c = cars[i];
+                uint64_t seen = lockCalendar(c);
+                forEachWord(dropFrom, day, [&](int w, uint64_t mask)
+                            { c.bookedDays[w].fetch_and(~mask, memory_order_relaxed); });
+                c.version.store(seen + 2, memory_order_release);
+            }
+        }
+        endDay.store(day + HorizonDays, memory_order_release);
+    }
+
+    // Days are [startDay, endDay): a car returned on a day can be picked up that day.
+    bool isFree(int carId, int startDay, int endDay) const
+    {
+        if (!validCar(carId) || !inWindow(startDay, endDay))
+            return false;
+        const CarCalendar *c = calendar(carId, false);
+        if (!c)
+            return true;
+        while (true)
+        {
+            uint64_t before = c->version.load(memory_order_acquire);
+            if (before & 1)
+                continue;
+            bool busy = overlaps(*c, startDay, endDay);
+            atomic_thread_fence(memory_order_acquire);
+            if (c->version.load(memory_order_relaxed) == before)
+                return !busy;
+        }
+    }
+    // With an `owner`, fails unless that car holds the id (see assign).
+    bool tryReserve(int carId, int startDay, int endDay, const void *owner = nullptr)
+    {
+        if (!validCar(carId) || !inWindow(startDay, endDay))
+            return false;
+        CarCalendar *c = calendar(carId, true);
+        while (true)
+        {
+            uint64_t seen = c->version.load(memory_order_acquire);
+            if (seen & 1)
+                continue;
+            if (overlaps(*c, startDay, endDay))
+            {
+                atomic_thread_fence(memory_order_acquire);
+                if (c->version.load(memory_order_relaxed) == seen)
+                    return false;
+                continue;
+            }
+            // Anyone who committed since we validated bumped the version, so the CAS fails and we revalidate.
+            if (!c->version.compare_exchange_weak(seen, seen + 1, memory_order_acquire, memory_order_relaxed))
+                continue;
+            // A slide that started meanwhile may already have cleared this car,
+            // and the id may have changed hands since the caller read it.
+            if (startDay < firstDay.load(memory_order_seq_cst) || (owner && c->owner.load(memory_order_relaxed) != owner))
+            {
+                c->version.store(seen, memory_order_release);
+                return false;
+            }
+            forEachWord(startDay, endDay, [&](int w, uint64_t mask)
+                        { c->bookedDays[w].fetch_or(mask, memory_order_relaxed); });
+            c->version.store(seen + 2, memory_order_release);
+            return true;
+        }
+    }
+    // Hands a car id to `owner` with an empty calendar.
+    void assign(int carId, const void *owner)
+    {
+        if (!validCar(carId))
+            return;
+        CarCalendar *c = calendar(carId, true);
+        uint64_t seen = lockCalendar(*c);
+        for (auto &word : c->bookedDays)
+            word.store(0, memory_order_relaxed);
+        c->owner.store(owner, memory_order_relaxed);
+        c->version.store(seen + 2, memory_order_release);
+    }
+    // Drops every booking for a car id and its owner, used when the id is handed back to the fleet.
+    void clear(int carId)
+    {
+        CarCalendar *c = validCar(carId) ? calendar(carId, false) : nullptr;
+        if (!c)
+            return;
+        uint64_t seen = lockCalendar(*c);
+        for (auto &word : c->bookedDays)
+            word.store(0, memory_order_relaxed);
+        c->owner.store(nullptr, memory_order_relaxed);
+        c->version.store(seen + 2, memory_order_release);
+    }
+    bool ownedBy(int carId, const void *owner) const
+    {
+        const CarCalendar *c = validCar(carId) ? calendar(carId, false) : nullptr;
+        return c && c->owner.load(memory_order_relaxed) == owner;
+    }
+};
+
+class CarPriceIndex
+{
+public:
+    // (price, car id)
+    using Entry = pair<int, int>;
+    using const_iterator = set<Entry>::const_iterator;
+    struct Range
+    {
+        const_iterator first, last;
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+    };
+private:
+    set<Entry> entries;
+public:
+    void insert(int price, int carId) { entries.emplace(price, carId); }
+    void erase(int price, int carId) { entries.erase({price, carId}); }
+    Range range(int low, int high) const
+    {
+        if (low > high)
+            return {entries.end(), entries.end()};
+        return {entries.lower_bound({low, INT_MIN}), entries.upper_bound({high, INT_MAX})};
+    }
+};
+
+// Cars are addressed by dense ids handed out on add. Hot attributes sit in
+// parallel columns and availability is one bit per id, so lookups are array
+// indexing and scans walk 64 cars per word.
+class FleetStore
+{
+private:
+    vector<shared_ptr<Car>> cars;
+    vector<int> prices;
+    vector<Location> locations;
+    vector<uint64_t> availableBits;
+    vector<int> freeIds;
+    size_t activeCount = 0;
+
+    static uint64_t bit(int id) { return 1ULL << (id & 63); }
+public:
+    int add(const shared_ptr<Car> &car)
+    {
+        int id;
+        if (!freeIds.empty())
+        {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else
+        {
+            id = (int)cars.size();
+            cars.emplace_back();
+            prices.push_back(0);
+            locations.emplace_back();
+            if ((id >> 6) >= (int)availableBits.size())
+                availableBits.push_back(0);
+        }
+        cars[id] = car;
+        prices[id] = car->getPrice();
+        locations[id] = car->getLocation();
+        availableBits[id >> 6] |= bit(id);
+        car->setId(id);
+        activeCount++;
+        return id;
+    }
+    void remove(int id)
+    {
+        if (!contains(id))
+            return;
+        cars[id]->setId(-1);
+        cars[id].reset();
+        availableBits[id >> 6] &= ~bit(id);
+        freeIds.push_back(id);
+        activeCount--;
+    }
+    bool contains(int id) const { return id >= 0 && id < (int)cars.size() && cars[id]; }
+    bool isAvailable(int id) const { return contains(id) && (availableBits[id >> 6] & bit(id)); }
+    void setAvailable(int id, bool available)
+    {
+        if (available)
+            availableBits[id >> 6] |= bit(id);
+        else
+            availableBits[id >> 6] &= ~bit(id);
+    }
+    int price(int id) const { return prices[id]; }
+    const Location &location(int id) const { return locations[id]; }
+    const shared_ptr<Car> &car(int id) const { return cars[id]; }
+    // True only for the car object that currently holds its id, so a stale id
+    // or a car from another fleet cannot act on whichever car reuses the slot.
+    bool owns(const shared_ptr<Car> &car) const { return car && contains(car->getId()) && cars[car->getId()] == car; }
+    size_t size() const { return activeCount; }
+    template <typename F>
+    void forEachAvailable(F &&f) const
+    {
+        for (size_t w = 0; w < availableBits.size(); w++)
+            for (uint64_t bits = availableBits[w]; bits; bits &= bits - 1)
+                f((int)(w * 64 + __builtin_ctzll(bits)));
+    }
+};
+
+struct PricingRules
+{
+    // Index 0 is Sunday.
+    array<double, 7> weekdayMultiplier{1.1, 1.0, 1.0, 1.0, 1.0, 1.2, 1.2};
+    // Index 0 is January.
+    array<double, 12> monthMultiplier{1.0, 1.0, 1.0, 1.0, 1.1, 1.25, 1.25, 1.25, 1.0, 1.0, 1.1, 1.3};
+    // (minimum days, fraction off), checked longest first.
+    vector<pair<int, double>> lengthDiscounts{{30, 0.25}, {7, 0.10}};
+};
+
+// A batch of candidate rentals in structure-of-arrays form; quote() fills totals.
+struct QuoteBatch
+{
+    vector<int> pricePerDay, startDay, endDay, totals;
+    void add(int price, int start, int end)
+    {
+        pricePerDay.push_back(price);
+        startDay.push_back(start);
+        endDay.push_back(end);
+    }
+    size_t size() const { return pricePerDay.size(); }
+};
+
+// Folds the per-day weekday/season multipliers into a prefix-sum table, so a
+// quote is two lookups, a subtraction and the length discount lookup. The
+// table spans one 400-year Gregorian cycle (146097 days, a whole number of
+// weeks), after which weekdays and months repeat, so it covers every date.
+// The batch loop is branch-free over flat arrays.
+class QuoteEngine
+{
+private:
+    static const int CycleDays = 146097;
+    int firstDay, horizonDays;
+    vector<double> factorPrefix;    // factorPrefix[d] = sum of day factors over [firstDay, firstDay + d)
+    vector<double> discountByDays;  // multiplier for a rental of n days; longer rentals use n = horizonDays
+
+    // Sum of day factors over [firstDay, day), negative for earlier days.
+    double factorsBefore(int day) const
+    {
+        int offset = day - firstDay;
+        if ((unsigned)offset <= (unsigned)CycleDays)
+            return factorPrefix[offset]; // the next 400 years
+        int cycles = offset >= 0 ? offset / CycleDays : -((CycleDays - 1 - offset) / CycleDays);
+        return cycles * factorPrefix[CycleDays] + factorPrefix[offset - cycles * CycleDays];
+    }
+public:
+    QuoteEngine(int firstDay, int horizonDays, const PricingRules &rules = PricingRules())
+        : firstDay(firstDay), horizonDays(horizonDays), factorPrefix(CycleDays + 1, 0), discountByDays(horizonDays + 1, 1)
+    {
+        for (int d = 0; d < CycleDays; d++)
+        {
+            int day = firstDay + d;
+            // Civil month of a day number (see toDayNumber).
+            int z = day + 719468, era = (z >= 0 ? z : z - 146096) / 146097, doe = z - era * 146097;
+            int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            int mp = (5 * (doe - (365 * yoe + yoe / 4 - yoe / 100)) + 2) / 153;
+            int month = mp < 10 ? mp + 2 : mp - 10;
+            int weekday = ((day % 7) + 11) % 7;
+            factorPrefix[d + 1] = factorPrefix[d] + rules.weekdayMultiplier[weekday] * rules.monthMultiplier[month];
+        }
+        for (int n = 0; n <= horizonDays; n++)
+            for (auto &tier : rules.lengthDiscounts)
+                if (n >= tier.first)
+                {
+                    discountByDays[n] = 1 - tier.second;
+                    break;
+                }
+    }
+    void quote(QuoteBatch &batch) const
+    {
+        size_t n = batch.size();
+        batch.totals.resize(n);
+        const int *price = batch.pricePerDay.data(), *start = batch.startDay.data(), *end = batch.endDay.data();
+        int *total = batch.totals.data();
+        const double *discount = discountByDays.data();
+        for (size_t i = 0; i < n; i++)
+        {
+            int days = min(max(end[i] - start[i], 0), horizonDays);
+            double factors = end[i] > start[i] ? factorsBefore(end[i]) - factorsBefore(start[i]) : 0;
+            total[i] = (int)(price[i] * factors * discount[days] + 0.5);
+        }
+    }
+    int quote(int pricePerDay, int startDay, int endDay) const
+    {
+        QuoteBatch one;
+        one.add(pricePerDay, startDay, endDay);
+        quote(one);
+        return one.totals[0];
+    }
 };
 
 class IRentalSystemInterface
@@ -75,76 +524,285 @@ public:
     virtual void removeCar(shared_ptr<Car> car) = 0;
     virtual bool makeReservation(shared_ptr<Reservation> r) = 0;
     virtual vector<shared_ptr<Car>> searchCarsByPrice(int start, int end) = 0;
+    virtual vector<CarPriceIndex::Entry> carsInPriceRange(int low, int high) = 0;
+    virtual vector<shared_ptr<Car>> searchCarsForDates(int low, int high, const string &start, const string &end) = 0;
+    virtual vector<shared_ptr<Car>> findNearestCars(const Location &at, int k, int maxPrice, const string &start, const string &end) = 0;
+    virtual int quotePrice(const shared_ptr<Car> &car, const string &start, const string &end) = 0;
+    virtual void quoteBatch(QuoteBatch &batch) = 0;
     virtual vector<shared_ptr<Car>> getAllCars() = 0;
     virtual vector<shared_ptr<Car>> getAvailableCars() = 0;
     virtual ~IRentalSystemInterface() = default;
 };
 
-class CarAvailabilityService
+// Uniform grid of square cells over the metro area; cars outside it are
+// clamped into the border cells. Nearest-K searches walk rings of cells
+// outward from the query and stop once no unvisited cell can beat the K-th hit.
+class CarSpatialIndex
 {
 private:
-    map<shared_ptr<Car>, bool> carAvailability;
+    Location origin;
+    double cellKm;
+    int cols, rows;
+    vector<vector<int>> cells;
+    vector<int> cellOf, slotOf;
+
+    int clampCol(double x) const { return min(cols - 1, max(0, (int)floor((x - origin.x) / cellKm))); }
+    int clampRow(double y) const { return min(rows - 1, max(0, (int)floor((y - origin.y) / cellKm))); }
 public:
-    void addCar(shared_ptr<Car> car) { carAvailability[car] = true; }
-    void removeCar(shared_ptr<Car> car) { carAvailability.erase(car); }
-    bool isAvailable(shared_ptr<Car> car)
+    CarSpatialIndex(Location origin, double widthKm, double heightKm, double cellKm)
+        : origin(origin), cellKm(cellKm), cols(max(1, (int)ceil(widthKm / cellKm))), rows(max(1, (int)ceil(heightKm / cellKm))),
+          cells((size_t)cols * rows) {}
+    void insert(int carId, const Location &at)
     {
-        return carAvailability.count(car) && carAvailability[car];
+        if (carId >= (int)cellOf.size())
+        {
+            cellOf.resize(carId + 1, -1);
+            slotOf.resize(carId + 1, -1);
+        }
+        int cell = clampRow(at.y) * cols + clampCol(at.x);
+        cellOf[carId] = cell;
+        slotOf[carId] = (int)cells[cell].size();
+        cells[cell].push_back(carId);
     }
-    bool bookCar(shared_ptr<Car> car)
+    void erase(int carId)
     {
-        if (isAvailable(car))
+        if (carId < 0 || carId >= (int)cellOf.size() || cellOf[carId] < 0)
+            return;
+        auto &cell = cells[cellOf[carId]];
+        int moved = cell.back();
+        cell[slotOf[carId]] = moved;
+        slotOf[moved] = slotOf[carId];
+        cell.pop_back();
+        cellOf[carId] = slotOf[carId] = -1;
+    }
+    // Up to k ids accepted by `accept`, nearest first. `where` maps an id to its location.
+    template <typename Where, typename Accept>
+    vector<int> nearest(const Location &at, int k, Where &&where, Accept &&accept) const
+    {
+        vector<pair<double, int>> best; // max-heap on distance
+        if (k <= 0)
+            return {};
+        int cx = clampCol(at.x), cy = clampRow(at.y);
+        // Distance from the query to the edge of its own cell bounds how close ring r can be.
+        double inset = min({at.x - (origin.x + cx * cellKm), origin.x + (cx + 1) * cellKm - at.x,
+                            at.y - (origin.y + cy * cellKm), origin.y + (cy + 1) * cellKm - at.y});
+        inset = max(0.0, inset);
+        int maxRing = max({cx, cols - 1 - cx, cy, rows - 1 - cy});
+        for (int r = 0; r <= maxRing; r++)
         {
-            carAvailability[car] = false;
-            return true;
+            if ((int)best.size() == k && best.front().first <= inset + (r - 1) * cellKm)
+                break;
+            for (int row = max(0, cy - r); row <= min(rows - 1, cy + r); row++)
+            {
+                bool edgeRow = row == cy - r || row == cy + r;
+                int step = edgeRow ? 1 : 2 * r;
+                for (int col = cx - r; col <= cx + r; col += max(1, step))
+                {
+                    if (col < 0 || col >= cols)
+                        continue;
+                    for (int id : cells[row * cols + col])
+                    {
+                        double d = where(id).distanceTo(at);
+                        if ((int)best.size() == k && d >= best.front().first)
+                            continue;
+                        if (!accept(id))
+                            continue;
+                        best.emplace_back(d, id);
+                        push_heap(best.begin(), best.end());
+                        if ((int)best.size() > k)
+                        {
+                            pop_heap(best.begin(), best.end());
+                            best.pop_back();
+                        }
+                    }
+                }
+            }
         }
-        return false;
+        sort_heap(best.begin(), best.end());
+        vector<int> ids;
+        for (auto &hit : best)
+            ids.push_back(hit.second);
+        return ids;
     }
-    vector<shared_ptr<Car>> getAvailableCars()
+};
+
+class CarAvailabilityService
+{
+private:
+    FleetStore fleet;
+    CarPriceIndex availableByPrice;
+    CarSpatialIndex byLocation;
+public:
+    // Defaults to a 60 km x 60 km metro area split into 500 m cells.
+    CarAvailabilityService(Location origin = {0, 0}, double widthKm = 60, double heightKm = 60, double cellKm = 0.5)
+        : byLocation(origin, widthKm, heightKm, cellKm) {}
+    void addCar(shared_ptr<Car> car)
+    {
+        if (fleet.owns(car))
+        {
+            if (!fleet.isAvailable(car->getId()))
+            {
+                fleet.setAvailable(car->getId(), true);
+                availableByPrice.insert(car->getPrice(), car->getId());
+            }
+            return;
+        }
+        int id = fleet.add(car);
+        availableByPrice.insert(fleet.price(id), id);
+        byLocation.insert(id, fleet.location(id));
+    }
+    void removeCar(shared_ptr<Car> car)
+    {
+        if (!fleet.owns(car))
+            return;
+        int id = car->getId();
+        if (fleet.isAvailable(id))
+            availableByPrice.erase(fleet.price(id), id);
+        byLocation.erase(id);
+        fleet.remove(id);
+    }
+    bool isAvailable(const shared_ptr<Car> &car) const { return fleet.owns(car) && fleet.isAvailable(car->getId()); }
+    bool bookCar(const shared_ptr<Car> &car)
+    {
+        if (!isAvailable(car))
+            return false;
+        int id = car->getId();
+        fleet.setAvailable(id, false);
+        availableByPrice.erase(fleet.price(id), id);
+        return true;
+    }
+    vector<shared_ptr<Car>> getAvailableCars() const
     {
         vector<shared_ptr<Car>> available;
-        for (const auto &pair : carAvailability)
-            if (pair.second)
-                available.push_back(pair.first);
+        fleet.forEachAvailable([&](int id) { available.push_back(fleet.car(id)); });
         return available;
     }
+    const FleetStore &getFleet() const { return fleet; }
+    CarPriceIndex::Range availableInPriceRange(int low, int high) const { return availableByPrice.range(low, high); }
+    template <typename Accept>
+    vector<int> nearestAvailable(const Location &at, int k, int maxPrice, Accept &&accept) const
+    {
+        return byLocation.nearest(
+            at, k, [&](int id) -> const Location & { return fleet.location(id); },
+            [&](int id) { return fleet.isAvailable(id) && fleet.price(id) <= maxPrice && accept(id); });
+    }
 };
 
+// Listing changes (addCar/removeCar) take the catalog lock exclusively and
+// searches take it shared. Reservations never touch the catalog: they go
+// straight to the ReservationEngine, which checks under the car's own version
+// lock that the car still holds its id, so concurrent bookings are serialised
+// per car rather than behind one lock.
 class RentalSystem : public IRentalSystemInterface
 {
 private:
     static shared_ptr<RentalSystem> rentalInstance;
     static once_flag initFlag;
     CarAvailabilityService availabilityService;
-    RentalSystem() {}
+    ReservationEngine reservations;
+    QuoteEngine quotes;
+    mutable shared_mutex catalogMutex;
+    ostream *log = &cout;
+    RentalSystem() : reservations(today()), quotes(today(), ReservationEngine::HorizonDays) {}
 public:
     static shared_ptr<RentalSystem> getInstance()
     {
         call_once(initFlag, []() 
         { 
-            rentalInstance = make_shared<RentalSystem>(); 
+            rentalInstance = shared_ptr<RentalSystem>(new RentalSystem()); 
         });
         return rentalInstance;
     }
-    void addCar(shared_ptr<Car> car) override { availabilityService.addCar(car); }
-    void removeCar(shared_ptr<Car> car) override { availabilityService.removeCar(car); }
+    // Where booking failures are reported; nullptr keeps them quiet.
+    void setLog(ostream *out) { log = out; }
+    void addCar(shared_ptr<Car> car) override
+    {
+        unique_lock<shared_mutex> lock(catalogMutex);
+        bool listed = availabilityService.getFleet().owns(car);
+        availabilityService.addCar(car);
+        if (!listed)
+            reservations.assign(car->getId(), car.get());
+    }
+    void removeCar(shared_ptr<Car> car) override
+    {
+        unique_lock<shared_mutex> lock(catalogMutex);
+        if (!availabilityService.getFleet().owns(car))
+            return;
+        // Calendar first, so no booking lands between the two.
+        reservations.clear(car->getId());
+        availabilityService.removeCar(car);
+    }
     bool makeReservation(shared_ptr<Reservation> r) override
     {
-        if (availabilityService.bookCar(r->getCar()))
+        int startDay = toDayNumber(r->getStart()), endDay = toDayNumber(r->getEnd());
+        reservations.slideTo(today());
+        if (!reservations.inWindow(startDay, endDay))
+        {
+            if (log)
+                *log << "Dates must fall between today and " << toDateString(today() + ReservationEngine::HorizonDays - 1) << ".\n";
+            return false;
+        }
+        const Car *car = r->getCar().get();
+        int id = car ? car->getId() : -1;
+        if (id >= 0 && reservations.tryReserve(id, startDay, endDay, car))
             return true;
-        cout << "Car is already booked.\n";
+        if (log)
+            *log << (id >= 0 && reservations.ownedBy(id, car) ? "Car is already booked.\n" : "Car is not listed.\n");
         return false;
     }
     vector<shared_ptr<Car>> searchCarsByPrice(int start, int end) override
     {
+        shared_lock<shared_mutex> lock(catalogMutex);
+        vector<shared_ptr<Car>> res;
+        for (auto &entry : availabilityService.availableInPriceRange(start, end))
+            res.push_back(availabilityService.getFleet().car(entry.second));
+        return res;
+    }
+    vector<shared_ptr<Car>> searchCarsForDates(int low, int high, const string &start, const string &end) override
+    {
+        int startDay = toDayNumber(start), endDay = toDayNumber(end);
+        reservations.slideTo(today());
+        shared_lock<shared_mutex> lock(catalogMutex);
         vector<shared_ptr<Car>> res;
-        for (auto &car : getAllCars())
-            if (car->getPrice() >= start && car->getPrice() <= end)
-                res.push_back(car);
+        for (auto &entry : availabilityService.availableInPriceRange(low, high))
+            if (reservations.isFree(entry.second, startDay, endDay))
+                res.push_back(availabilityService.getFleet().car(entry.second));
         return res;
     }
-    vector<shared_ptr<Car>> getAllCars() override { return availabilityService.getAvailableCars(); }
-    vector<shared_ptr<Car>> getAvailableCars() override { return availabilityService.getAvailableCars(); }
+    vector<shared_ptr<Car>> findNearestCars(const Location &at, int k, int maxPrice, const string &start, const string &end) override
+    {
+        int startDay = toDayNumber(start), endDay = toDayNumber(end);
+        reservations.slideTo(today());
+        shared_lock<shared_mutex> lock(catalogMutex);
+        vector<shared_ptr<Car>> res;
+        for (int id : availabilityService.nearestAvailable(at, k, maxPrice, [&](int id)
+                                                           { return reservations.isFree(id, startDay, endDay); }))
+            res.push_back(availabilityService.getFleet().car(id));
+        return res;
+    }
+    int quotePrice(const shared_ptr<Car> &car, const string &start, const string &end) override
+    {
+        return quotes.quote(car->getPrice(), toDayNumber(start), toDayNumber(end));
+    }
+    void quoteBatch(QuoteBatch &batch) override { quotes.quote(batch); }
+    // (price, car id) pairs copied out under the catalog lock: cheaper than
+    // searchCarsByPrice's shared_ptrs and safe against concurrent listing changes.
+    vector<CarPriceIndex::Entry> carsInPriceRange(int low, int high) override
+    {
+        shared_lock<shared_mutex> lock(catalogMutex);
+        auto range = availabilityService.availableInPriceRange(low, high);
+        return vector<CarPriceIndex::Entry>(range.begin(), range.end());
+    }
+    vector<shared_ptr<Car>> getAllCars() override
+    {
+        shared_lock<shared_mutex> lock(catalogMutex);
+        return availabilityService.getAvailableCars();
+    }
+    vector<shared_ptr<Car>> getAvailableCars() override
+    {
+        shared_lock<shared_mutex> lock(catalogMutex);
+        return availabilityService.getAvailableCars();
+    }
 };
 
 shared_ptr<RentalSystem> RentalSystem::rentalInstance = nullptr;
@@ -154,7 +812,7 @@ class CarRentalSystem
 {
 private:
     shared_ptr<IRentalSystemInterface> rental;
-    int reservationCounter;
+    atomic<int> reservationCounter;
 public:
     CarRentalSystem(shared_ptr<IRentalSystemInterface> rentalSystem) : rental(rentalSystem), reservationCounter(0) {}
     shared_ptr<Reservation> reserveCar(shared_ptr<User> user, shared_ptr<Car> car, shared_ptr<IPaymentStrategy> paymentStrategy, const string &start, const string &end)
@@ -164,7 +822,7 @@ public:
 
         if (rental->makeReservation(reservation))
         {
-            paymentStrategy->makePayment(car->getPrice());
+            paymentStrategy->makePayment(rental->quotePrice(car, start, end));
             cout << "Car reserved successfully with Reservation ID: " << reservationId << endl;
             return reservation;
         }
@@ -179,24 +837,358 @@ public:
     {
         return rental->searchCarsByPrice(low, high);
     }
+    vector<CarPriceIndex::Entry> carsInPriceRange(int low, int high)
+    {
+        return rental->carsInPriceRange(low, high);
+    }
+    vector<shared_ptr<Car>> searchCarsForDates(int low, int high, const string &start, const string &end)
+    {
+        return rental->searchCarsForDates(low, high, start, end);
+    }
+    vector<shared_ptr<Car>> findNearestCars(const Location &at, int k, int maxPrice, const string &start, const string &end)
+    {
+        return rental->findNearestCars(at, k, maxPrice, start, end);
+    }
     vector<shared_ptr<Car>> getAllAvailableCars()
     {
         return rental->getAvailableCars();
     }
 };
 
-int main()
+void benchmarkPriceSearch()
+{
+    mt19937 gen(42);
+    uniform_int_distribution<> price(20, 500);
+    for (int fleet : {1000, 10000, 100000, 1000000})
+    {
+        CarAvailabilityService service;
+        for (int i = 0; i < fleet; i++)
+            service.addCar(make_shared<Car>("Maker", "Model", "2024", price(gen)));
+        const int queries = fleet >= 100000 ? 20 : 200;
+        long long sink = 0;
+
+        auto t0 = chrono::steady_clock::now();
+        for (int q = 0; q < queries; q++)
+            for (auto &car : service.getAvailableCars())
+                if (car->getPrice() >= 100 && car->getPrice() <= 110)
+                    sink++;
+        auto t1 = chrono::steady_clock::now();
+        for (int q = 0; q < queries; q++)
+            for (auto &entry : service.availableInPriceRange(100, 110))
+                sink += service.getFleet().price(entry.second) > 0;
+        auto t2 = chrono::steady_clock::now();
+
+        auto perQuery = [&](chrono::steady_clock::duration d)
+        { return chrono::duration<double, micro>(d).count() / queries; };
+        cout << "fleet " << fleet << ": scan " << perQuery(t1 - t0) << " us/query, index "
+             << perQuery(t2 - t1) << " us/query (" << sink << ")\n";
+    }
+}
+
+void benchmarkFleetStore()
+{
+    const int n = 1000000;
+    vector<shared_ptr<Car>> cars;
+    for (int i = 0; i < n; i++)
+        cars.push_back(make_shared<Car>("Maker", "Model", "2024", 20 + i % 480));
+    auto ms = [](chrono::steady_clock::time_point from)
+    { return chrono::duration<double, milli>(chrono::steady_clock::now() - from).count(); };
+    long long sink = 0;
+
+    // The map<shared_ptr<Car>, bool> availability table this store replaced.
+    map<shared_ptr<Car>, bool> legacy;
+    auto t = chrono::steady_clock::now();
+    for (auto &car : cars)
+        legacy[car] = true;
+    cout << "map   add " << ms(t) << " ms";
+    t = chrono::steady_clock::now();
+    for (auto &car : cars)
+        if (legacy.count(car) && legacy[car])
+            legacy[car] = false;
+    cout << ", book " << ms(t) << " ms";
+    t = chrono::steady_clock::now();
+    for (auto &pair : legacy)
+        sink += !pair.second;
+    cout << ", scan " << ms(t) << " ms";
+    t = chrono::steady_clock::now();
+    for (auto &car : cars)
+        legacy.erase(car);
+    cout << ", remove " << ms(t) << " ms\n";
+
+    FleetStore fleet;
+    t = chrono::steady_clock::now();
+    for (auto &car : cars)
+        fleet.add(car);
+    cout << "fleet add " << ms(t) << " ms";
+    t = chrono::steady_clock::now();
+    for (auto &car : cars)
+        if (fleet.isAvailable(car->getId()))
+            fleet.setAvailable(car->getId(), false);
+    cout << ", book " << ms(t) << " ms";
+    for (int id = 0; id < n; id += 2)
+        fleet.setAvailable(id, true);
+    t = chrono::steady_clock::now();
+    fleet.forEachAvailable([&](int id) { sink += fleet.price(id); });
+    cout << ", scan " << ms(t) << " ms";
+    t = chrono::steady_clock::now();
+    for (auto &car : cars)
+        fleet.remove(car->getId());
+    cout << ", remove " << ms(t) << " ms (" << sink << ")\n";
+}
+
+struct Booking
+{
+    int carId, startDay, endDay;
+};
+
+// Returns false if two accepted bookings of the same car share a day.
+bool bookingsDisjoint(vector<Booking> bookings)
+{
+    sort(bookings.begin(), bookings.end(), [](const Booking &a, const Booking &b)
+         { return tie(a.carId, a.startDay) < tie(b.carId, b.startDay); });
+    for (size_t i = 1; i < bookings.size(); i++)
+        if (bookings[i].carId == bookings[i - 1].carId && bookings[i].startDay < bookings[i - 1].endDay)
+            return false;
+    return true;
+}
+
+void benchmarkConcurrentReservations()
+{
+    const int fleetSize = 100000, opsPerThread = 200000;
+    const int firstDay = toDayNumber("2025-01-01");
+    CarAvailabilityService catalog;
+    mt19937 gen(7);
+    for (int i = 0; i < fleetSize; i++)
+        catalog.addCar(make_shared<Car>("Maker", "Model", "2024", 20 + gen() % 480));
+
+    int maxThreads = max(4u, thread::hardware_concurrency());
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        // 80% date-filtered price searches, 20% reservations of random cars.
+        ReservationEngine engine(firstDay);
+        vector<vector<Booking>> accepted(threads);
+        auto worker = [&](int t)
+        {
+            mt19937 rng(t + 1);
+            long long found = 0;
+            for (int op = 0; op < opsPerThread; op++)
+            {
+                int start = firstDay + rng() % 300, end = start + 1 + rng() % 7;
+                if (rng() % 5)
+                {
+                    int low = 20 + rng() % 470, page = 0;
+                    for (auto &entry : catalog.availableInPriceRange(low, low + 10))
+                    {
+                        if (engine.isFree(entry.second, start, end))
+                            found++;
+                        if (++page == 20)
+                            break;
+                    }
+                }
+                else
+                {
+                    int carId = rng() % fleetSize;
+                    if (engine.tryReserve(carId, start, end))
+                        accepted[t].push_back({carId, start, end});
+                }
+            }
+            return found;
+        };
+        auto t0 = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (int t = 0; t < threads; t++)
+            pool.emplace_back(worker, t);
+        for (auto &th : pool)
+            th.join();
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        vector<Booking> all;
+        for (auto &list : accepted)
+            all.insert(all.end(), list.begin(), list.end());
+        cout << threads << " threads: " << (long long)(threads * opsPerThread / secs) << " mixed ops/s, "
+             << all.size() << " bookings" << (bookingsDisjoint(all) ? "" : ", OVERLAP DETECTED") << "\n";
+    }
+
+    // Stress: every thread fights over the same 16 cars for the same month.
+    ReservationEngine engine(firstDay);
+    vector<vector<Booking>> accepted(maxThreads);
+    vector<thread> pool;
+    for (int t = 0; t < maxThreads; t++)
+        pool.emplace_back([&, t]()
+                          {
+            mt19937 rng(100 + t);
+            for (int op = 0; op < 100000; op++)
+            {
+                int carId = rng() % 16, start = firstDay + rng() % 30, end = start + 1 + rng() % 4;
+                if (engine.tryReserve(carId, start, end))
+                    accepted[t].push_back({carId, start, end});
+            } });
+    for (auto &th : pool)
+        th.join();
+    vector<Booking> all;
+    for (auto &list : accepted)
+        all.insert(all.end(), list.begin(), list.end());
+    cout << "stress: " << all.size() << " bookings accepted, "
+         << (bookingsDisjoint(all) ? "no overlaps" : "OVERLAP DETECTED") << "\n";
+}
+
+// The same mixed workload through RentalSystem, so bookings pay for the
+// owner check and searches for the catalog lock.
+void benchmarkRentalSystem()
 {
+    const int fleetSize = 100000, opsPerThread = 200000;
+    auto system = RentalSystem::getInstance();
+    system->setLog(nullptr);
+    mt19937 gen(7);
+    uniform_real_distribution<> coord(0, 60);
+    vector<shared_ptr<Car>> cars;
+    for (int i = 0; i < fleetSize; i++)
+    {
+        cars.push_back(make_shared<Car>("Maker", "Model", "2024", 20 + gen() % 480, Location{coord(gen), coord(gen)}));
+        system->addCar(cars.back());
+    }
+    const int firstDay = today();
+    int maxThreads = max(4u, thread::hardware_concurrency());
+    for (int searchPercent : {80, 0})
+    {
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            atomic<long long> booked{0};
+            auto worker = [&](int t)
+            {
+                mt19937 rng(1000 * searchPercent + t + 1);
+                uniform_real_distribution<> at(0, 60);
+                for (int op = 0; op < opsPerThread; op++)
+                {
+                    int start = firstDay + 1 + rng() % 300, end = start + 1 + rng() % 7;
+                    string from = toDateString(start), to = toDateString(end);
+                    if ((int)(rng() % 100) < searchPercent)
+                        system->findNearestCars({at(rng), at(rng)}, 5, 300, from, to);
+                    else if (system->makeReservation(make_shared<Reservation>(op, nullptr, cars[rng() % fleetSize], from, to)))
+                        booked++;
+                }
+            };
+            auto t0 = chrono::steady_clock::now();
+            vector<thread> pool;
+            for (int t = 0; t < threads; t++)
+                pool.emplace_back(worker, t);
+            for (auto &th : pool)
+                th.join();
+            double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            cout << "rental system, " << searchPercent << "% searches, " << threads << " threads: "
+                 << (long long)(threads * opsPerThread / secs) << " ops/s, " << booked << " bookings\n";
+        }
+    }
+}
+
+void benchmarkNearestSearch()
+{
+    const int fleetSize = 1000000, queries = 2000, k = 10;
+    const int firstDay = toDayNumber("2025-01-01");
+    CarAvailabilityService catalog;
+    ReservationEngine engine(firstDay);
+    mt19937 gen(11);
+    uniform_real_distribution<> coord(0, 60);
+    for (int i = 0; i < fleetSize; i++)
+        catalog.addCar(make_shared<Car>("Maker", "Model", "2024", 20 + gen() % 480, Location{coord(gen), coord(gen)}));
+    for (int i = 0; i < fleetSize / 2; i++)
+    {
+        int start = firstDay + gen() % 60;
+        engine.tryReserve(gen() % fleetSize, start, start + 1 + gen() % 7);
+    }
+    const FleetStore &fleet = catalog.getFleet();
+    auto bruteForce = [&](const Location &at, int budget, int start, int end)
+    {
+        vector<pair<double, int>> hits;
+        fleet.forEachAvailable([&](int id)
+                               {
+            if (fleet.price(id) <= budget && engine.isFree(id, start, end))
+                hits.emplace_back(fleet.location(id).distanceTo(at), id); });
+        sort(hits.begin(), hits.end());
+        vector<int> ids;
+        for (int i = 0; i < k && i < (int)hits.size(); i++)
+            ids.push_back(hits[i].second);
+        return ids;
+    };
+
+    long long found = 0;
+    int mismatches = 0;
+    double gridMicros = 0, scanMicros = 0;
+    for (int q = 0; q < queries; q++)
+    {
+        Location at{coord(gen), coord(gen)};
+        int budget = 50 + gen() % 300, start = firstDay + gen() % 60, end = start + 3;
+        auto t0 = chrono::steady_clock::now();
+        auto ids = catalog.nearestAvailable(at, k, budget, [&](int id)
+                                            { return engine.isFree(id, start, end); });
+        auto t1 = chrono::steady_clock::now();
+        gridMicros += chrono::duration<double, micro>(t1 - t0).count();
+        found += ids.size();
+        if (q % 100 == 0)
+        {
+            auto expected = bruteForce(at, budget, start, end);
+            scanMicros += chrono::duration<double, micro>(chrono::steady_clock::now() - t1).count();
+            mismatches += ids != expected;
+        }
+    }
+    cout << "nearest " << k << " of " << fleetSize << " cars: grid " << gridMicros / queries << " us/query, scan "
+         << scanMicros / (queries / 100) << " us/query, " << mismatches << " mismatches (" << found << ")\n";
+}
+
+void benchmarkQuotes()
+{
+    const int firstDay = toDayNumber("2025-01-01"), options = 10000, requests = 1000;
+    QuoteEngine engine(firstDay, ReservationEngine::HorizonDays);
+    mt19937 gen(5);
+    QuoteBatch batch;
+    for (int i = 0; i < options; i++)
+    {
+        int start = firstDay + gen() % 600;
+        batch.add(20 + gen() % 480, start, start + 1 + gen() % 45);
+    }
+    long long sink = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < requests; r++)
+    {
+        batch.startDay[r % options] += r & 1;
+        engine.quote(batch);
+        sink += batch.totals[r % options];
+    }
+    double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count() / requests;
+    cout << "quote " << options << " options: " << micros << " us/request (" << sink << ")\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+    {
+        benchmarkQuotes();
+        benchmarkNearestSearch();
+        benchmarkConcurrentReservations();
+        benchmarkRentalSystem();
+        benchmarkFleetStore();
+        benchmarkPriceSearch();
+        return 0;
+    }
     auto rentalSystem = RentalSystem::getInstance();
     CarRentalSystem system(rentalSystem);
-    auto car1 = make_shared<Car>("Toyota", "Corolla", "2022", 50);
-    auto car2 = make_shared<Car>("Honda", "Civic", "2021", 55);
+    auto car1 = make_shared<Car>("Toyota", "Corolla", "2022", 50, Location{12.0, 7.5});
+    auto car2 = make_shared<Car>("Honda", "Civic", "2021", 55, Location{30.2, 18.4});
     rentalSystem->addCar(car1);
     rentalSystem->addCar(car2);
     auto user1 = make_shared<User>("Alice", "1234567890", "DL12345");
     auto paymentMethod = PaymentFactory::createPaymentMethod("UPI");
-    system.reserveCar(user1, car1, paymentMethod, "2025-02-28", "2025-03-05");
+    // Bookings are taken from today up to ReservationEngine::HorizonDays ahead.
+    int base = today() + 30;
+    auto day = [&](int offset) { return toDateString(base + offset); };
+    system.reserveCar(user1, car1, paymentMethod, day(0), day(5));
     auto availableCars = system.getAllAvailableCars();
     cout << "Available cars: " << availableCars.size() << endl;
+    system.reserveCar(user1, car1, paymentMethod, day(3), day(8));
+    system.reserveCar(user1, car1, paymentMethod, day(5), day(8));
+    system.reserveCar(user1, car2, paymentMethod, day(2000), day(2003));
+    for (auto &car : system.searchCarsForDates(40, 60, day(1), day(4)))
+        cout << "Free " << day(1) << ".." << day(4) << " at " << car->getPrice() << "/day" << endl;
+    for (auto &car : system.findNearestCars({28.0, 20.0}, 1, 60, day(1), day(4)))
+        cout << "Nearest free car is " << car->getLocation().distanceTo({28.0, 20.0}) << " km away" << endl;
     return 0;
 }
\ No newline at end of file
@@ -21,10 +21,20 @@ public:
         return notificationMethod; 
     }
     
-    void updateFeedback(int productId, int rating, string message) {
+    int getId() {
+        return uid;
+    }
+
+    void updateFeedback(int productId, int rating, const string& message) {
         feedbacks[productId] = {rating, message};
     }
 
+    // Current rating for a product, or -1 if the user has not rated it.
+    int getRating(int productId) {
+        auto it = feedbacks.find(productId);
+        return it == feedbacks.end() ? -1 : it->second.first;
+    }
+
     void getFeedback(int productId) {
         if (feedbacks.find(productId) != feedbacks.end()) {
             cout << "[Feedback] " << name << " rated " << feedbacks[productId].first 
@@ -79,21 +89,857 @@ public:
     }
 };
 
+struct NotificationRequest {
+    User* user = nullptr;
+    string message;
+};
+
+// Receives notifications a batch at a time from a dispatcher worker.
+class NotificationSink {
+public:
+    virtual void deliver(const vector<NotificationRequest>& batch) = 0;
+    virtual ~NotificationSink() {}
+};
+
+class WhatsappSink : public NotificationSink {
+public:
+    void deliver(const vector<NotificationRequest>& batch) override {
+        string out;
+        for (auto& n : batch) {
+            out += "[WhatsApp] Sent to " + n.user->getName() + ": " + n.message + "\n";
+        }
+        cout << out << flush;
+    }
+};
+
+class EmailSink : public NotificationSink {
+public:
+    void deliver(const vector<NotificationRequest>& batch) override {
+        string out;
+        for (auto& n : batch) {
+            out += "[Email] Sent to " + n.user->getName() + ": " + n.message + "\n";
+        }
+        cout << out << flush;
+    }
+};
+
+// Local sink for tests and benchmarks: counts, and keeps the last few messages.
+class StubSink : public NotificationSink {
+private:
+    atomic<uint64_t> received{0};
+    mutex mtx;
+    deque<string> recent;
+public:
+    void deliver(const vector<NotificationRequest>& batch) override {
+        received += batch.size();
+        lock_guard<mutex> lock(mtx);
+        for (auto& n : batch) {
+            recent.push_back(n.message);
+            if (recent.size() > 16) {
+                recent.pop_front();
+            }
+        }
+    }
+    uint64_t count() const {
+        return received.load();
+    }
+    vector<string> lastMessages() {
+        lock_guard<mutex> lock(mtx);
+        return vector<string>(recent.begin(), recent.end());
+    }
+};
+
+// Bounded multi-producer, single-consumer ring (Vyukov's sequence-per-cell
+// scheme). Producers claim a cell with one CAS on the tail; the consumer owns
+// the head outright.
+template <typename T>
+class BoundedMpscQueue {
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+    vector<Cell> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> tail{0};
+    alignas(64) size_t head = 0;
+public:
+    explicit BoundedMpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells = vector<Cell>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+    bool tryPush(T&& value) {
+        size_t pos = tail.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            intptr_t diff = (intptr_t)cell.sequence.load(memory_order_acquire) - (intptr_t)pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.value = move(value);
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(memory_order_relaxed);
+            }
+        }
+    }
+    bool tryPop(T& out) {
+        Cell& cell = cells[head & mask];
+        if (cell.sequence.load(memory_order_acquire) != head + 1) {
+            return false;
+        }
+        out = move(cell.value);
+        cell.sequence.store(head + mask + 1, memory_order_release);
+        head++;
+        return true;
+    }
+};
+
+// Producers enqueue notification requests and return at once; one worker per
+// channel drains its queue in batches into that channel's sink. A full queue
+// either blocks the producer or drops the request, per `Backpressure`.
+class NotificationDispatcher {
+public:
+    enum Backpressure {
+        BLOCK,
+        DROP
+    };
+    struct Stats {
+        uint64_t enqueued = 0, dropped = 0, delivered = 0, batches = 0;
+    };
+private:
+    struct Lane {
+        BoundedMpscQueue<NotificationRequest> queue;
+        unique_ptr<NotificationSink> sink;
+        thread worker;
+        atomic<uint64_t> enqueued{0}, dropped{0}, delivered{0}, batches{0};
+        atomic<bool> sleeping{false};
+        mutex mtx;
+        condition_variable wake;
+        Lane(size_t capacity, unique_ptr<NotificationSink> s) : queue(capacity), sink(move(s)) {}
+    };
+    size_t capacity, maxBatch;
+    Backpressure policy;
+    unordered_map<string, unique_ptr<Lane>> lanes;
+    atomic<bool> running{false};
+
+    void drain(Lane& lane) {
+        vector<NotificationRequest> batch;
+        batch.reserve(maxBatch);
+        while (true) {
+            NotificationRequest request;
+            while (batch.size() < maxBatch && lane.queue.tryPop(request)) {
+                batch.push_back(move(request));
+            }
+            if (!batch.empty()) {
+                lane.sink->deliver(batch);
+                lane.delivered += batch.size();
+                lane.batches++;
+                batch.clear();
+                continue;
+            }
+            if (!running.load()) {
+                return;
+            }
+            // Nothing queued: sleep until a producer sees the flag, or 1 ms as a safety net.
+            unique_lock<mutex> lock(lane.mtx);
+            lane.sleeping.store(true);
+            lane.wake.wait_for(lock, chrono::milliseconds(1));
+            lane.sleeping.store(false);
+        }
+    }
+public:
+    NotificationDispatcher(size_t capacityPerChannel = 4096, Backpressure backpressure = BLOCK, size_t maxBatch = 256)
+        : capacity(capacityPerChannel), maxBatch(maxBatch), policy(backpressure) {}
+    ~NotificationDispatcher() {
+        stop();
+    }
+    // Channels are fixed once the dispatcher starts.
+    void registerChannel(const string& type, unique_ptr<NotificationSink> sink) {
+        if (!running.load()) {
+            lanes[type] = make_unique<Lane>(capacity, move(sink));
+        }
+    }
+    void start() {
+        if (running.exchange(true)) {
+            return;
+        }
+        for (auto& lane : lanes) {
+            Lane* l = lane.second.get();
+            l->worker = thread([this, l] { drain(*l); });
+        }
+    }
+    // Delivers everything already queued, then joins the workers. Requests
+    // racing with stop() may be dropped.
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        for (auto& lane : lanes) {
+            lane.second->wake.notify_one();
+            lane.second->worker.join();
+        }
+    }
+    // Waits until every accepted request so far has reached its sink.
+    void flush() {
+        for (auto& lane : lanes) {
+            Lane& l = *lane.second;
+            while (running.load() && l.delivered.load() < l.enqueued.load()) {
+                this_thread::yield();
+            }
+        }
+    }
+    bool notify(const string& type, User* user, string message) {
+        auto it = lanes.find(type);
+        if (it == lanes.end() || !running.load()) {
+            return false;
+        }
+        Lane& lane = *it->second;
+        NotificationRequest request{user, move(message)};
+        while (!lane.queue.tryPush(move(request))) {
+            if (policy == DROP || !running.load()) {
+                lane.dropped++;
+                return false;
+            }
+            this_thread::yield();
+        }
+        lane.enqueued++;
+        if (lane.sleeping.load()) {
+            lane.wake.notify_one();
+        }
+        return true;
+    }
+    Stats stats() const {
+        Stats total;
+        for (auto& lane : lanes) {
+            total.enqueued += lane.second->enqueued.load();
+            total.dropped += lane.second->dropped.load();
+            total.delivered += lane.second->delivered.load();
+            total.batches += lane.second->batches.load();
+        }
+        return total;
+    }
+};
+
 class FeedbackObserver {
 public:
-    virtual void onFeedbackReceived(int productId, int rating, User* user, string comments) = 0;
+    virtual void onFeedbackReceived(int productId, int rating, User* user, const string& comments) = 0;
     virtual ~FeedbackObserver() {}
 };
 
+// Running per-product rating statistics. Ratings are whole numbers 1-10, so a
+// ten-bucket histogram per product is already a fixed-size quantile sketch
+// with no approximation error; count and sum give the mean. Every query reads
+// one product's 48-byte row.
+class RatingAggregator {
+public:
+    static const int MinRating = 1, MaxRating = 10;
+private:
+    struct ProductStats {
+        uint32_t count = 0;
+        uint32_t sum = 0;
+        array<uint32_t, MaxRating - MinRating + 1> histogram{};
+    };
+    unordered_map<int, uint32_t> slotOf;
+    vector<ProductStats> stats;
+
+    static bool valid(int rating) {
+        return rating >= MinRating && rating <= MaxRating;
+    }
+    ProductStats& row(int productId) {
+        auto inserted = slotOf.emplace(productId, (uint32_t)stats.size());
+        if (inserted.second) {
+            stats.emplace_back();
+        }
+        return stats[inserted.first->second];
+    }
+    const ProductStats* find(int productId) const {
+        auto it = slotOf.find(productId);
+        return it == slotOf.end() ? nullptr : &stats[it->second];
+    }
+public:
+    void reserve(size_t products) {
+        slotOf.reserve(products);
+        stats.reserve(products);
+    }
+    // oldRating is -1 for a first rating; a re-rating moves the product's count between buckets.
+    void record(int productId, int oldRating, int newRating) {
+        if (!valid(newRating)) {
+            return;
+        }
+        ProductStats& s = row(productId);
+        if (valid(oldRating)) {
+            s.count--;
+            s.sum -= oldRating;
+            s.histogram[oldRating - MinRating]--;
+        }
+        s.count++;
+        s.sum += newRating;
+        s.histogram[newRating - MinRating]++;
+    }
+    uint32_t count(int productId) const {
+        auto s = find(productId);
+        return s ? s->count : 0;
+    }
+    double average(int productId) const {
+        auto s = find(productId);
+        return s && s->count ? (double)s->sum / s->count : 0;
+    }
+    // Smallest rating at or below which a fraction q of the product's ratings fall; 0 if unrated.
+    int quantile(int productId, double q) const {
+        auto s = find(productId);
+        if (!s || !s->count) {
+            return 0;
+        }
+        uint64_t target = max<uint64_t>(1, (uint64_t)ceil(q * s->count)), seen = 0;
+        for (int r = 0; r < (int)s->histogram.size(); r++) {
+            seen += s->histogram[r];
+            if (seen >= target) {
+                return r + MinRating;
+            }
+        }
+        return MaxRating;
+    }
+    size_t products() const {
+        return stats.size();
+    }
+    // Rows plus an estimate of the id -> row hash map.
+    size_t memoryBytes() const {
+        return stats.capacity() * sizeof(ProductStats) +
+               slotOf.bucket_count() * sizeof(void*) + slotOf.size() * (sizeof(pair<int, uint32_t>) + sizeof(void*));
+    }
+};
+
+// Append-only feedback log in columns: product, user, rating and time sit in
+// flat arrays and comment text is packed into one arena addressed by offset.
+// An inverted index maps each lower-cased comment term to the ascending ids
+// of records using it, so a search intersects posting lists and then checks
+// the rating column instead of reading every comment.
+class FeedbackStore {
+private:
+    vector<int32_t> productIds, userIds;
+    vector<uint8_t> ratings;
+    vector<uint32_t> times;
+    vector<uint64_t> commentStart; // record i's text is arena[commentStart[i], commentStart[i + 1])
+    string arena;
+    unordered_map<string, uint32_t> termIds;
+    vector<vector<uint32_t>> postings;
+
+    template <typename F>
+    static void forEachTerm(const string& text, F&& f) {
+        string term;
+        for (size_t i = 0; i <= text.size(); i++) {
+            unsigned char c = i < text.size() ? text[i] : ' ';
+            if (isalnum(c)) {
+                term += (char)tolower(c);
+            } else if (!term.empty()) {
+                f(term);
+                term.clear();
+            }
+        }
+    }
+public:
+    FeedbackStore() : commentStart{0} {}
+
+    uint32_t append(int productId, int userId, int rating, const string& comment, uint32_t time) {
+        uint32_t id = (uint32_t)productIds.size();
+        productIds.push_back(productId);
+        userIds.push_back(userId);
+        ratings.push_back((uint8_t)rating);
+        times.push_back(time);
+        arena += comment;
+        commentStart.push_back(arena.size());
+        forEachTerm(comment, [&](const string& term) {
+            auto it = termIds.emplace(term, (uint32_t)postings.size()).first;
+            if (it->second == postings.size()) {
+                postings.emplace_back();
+            }
+            auto& list = postings[it->second];
+            if (list.empty() || list.back() != id) {
+                list.push_back(id);
+            }
+        });
+        return id;
+    }
+    // Records whose comment contains every term of `text`, with a rating in [minRating, maxRating].
+    vector<uint32_t> search(const string& text, int minRating = 1, int maxRating = 10) const {
+        vector<const vector<uint32_t>*> lists;
+        bool missing = false;
+        forEachTerm(text, [&](const string& term) {
+            auto it = termIds.find(term);
+            if (it == termIds.end()) {
+                missing = true;
+            } else {
+                lists.push_back(&postings[it->second]);
+            }
+        });
+        vector<uint32_t> result;
+        if (missing || lists.empty()) {
+            return result;
+        }
+        // Walk the shortest list; the others only ever move forward, so each is searched from its cursor.
+        sort(lists.begin(), lists.end(), [](auto a, auto b) { return a->size() < b->size(); });
+        vector<vector<uint32_t>::const_iterator> cursors;
+        for (auto list : lists) {
+            cursors.push_back(list->begin());
+        }
+        for (uint32_t id : *lists[0]) {
+            bool all = true;
+            for (size_t l = 1; l < lists.size() && all; l++) {
+                cursors[l] = lower_bound(cursors[l], lists[l]->end(), id);
+                all = cursors[l] != lists[l]->end() && *cursors[l] == id;
+            }
+            if (all && ratings[id] >= minRating && ratings[id] <= maxRating) {
+                result.push_back(id);
+            }
+        }
+        return result;
+    }
+    size_t size() const {
+        return productIds.size();
+    }
+    int productId(uint32_t id) const {
+        return productIds[id];
+    }
+    int userId(uint32_t id) const {
+        return userIds[id];
+    }
+    int rating(uint32_t id) const {
+        return ratings[id];
+    }
+    uint32_t time(uint32_t id) const {
+        return times[id];
+    }
+    string_view comment(uint32_t id) const {
+        return string_view(arena).substr(commentStart[id], commentStart[id + 1] - commentStart[id]);
+    }
+    // Columns, arena and postings; the term dictionary is estimated.
+    size_t memoryBytes() const {
+        size_t bytes = productIds.capacity() * 4 + userIds.capacity() * 4 + ratings.capacity() + times.capacity() * 4 +
+                       commentStart.capacity() * 8 + arena.capacity();
+        for (auto& list : postings) {
+            bytes += list.capacity() * sizeof(uint32_t) + sizeof(list);
+        }
+        for (auto& term : termIds) {
+            bytes += term.first.capacity() + sizeof(term) + 2 * sizeof(void*);
+        }
+        return bytes;
+    }
+};
+
+struct FeedbackEvent {
+    int productId = 0;
+    int rating = 0;
+    User* user = nullptr;
+    string comments;
+};
+
+// Fans feedback out to observers without running them on the ingest thread.
+// Every subscriber gets its own bounded queue and worker, so a slow observer
+// only backs up its own queue and each observer sees events in publish order.
+// Publish never waits on a full queue: per `Overflow` it either spills the
+// event to the subscriber's unbounded overflow list, which the worker drains
+// after the ring, or drops and counts it.
+// Subscriptions live in a fixed table of atomic slots: publish, subscribe and
+// unsubscribe are CAS/loads only. Publishers register in the current epoch
+// while they hold lane pointers; unsubscribe unlinks a lane and retires it,
+// and a retired lane is freed once its worker has drained it and the epoch
+// has moved on twice, after which no publisher can still see it.
+class ObserverBus {
+public:
+    static const int MaxSubscribers = 64;
+    enum Overflow {
+        SPILL,
+        DROP
+    };
+private:
+    struct Lane {
+        shared_ptr<FeedbackObserver> observer;
+        BoundedMpscQueue<FeedbackEvent> queue;
+        atomic<bool> active{true}, sleeping{false}, finished{false};
+        atomic<uint64_t> published{0}, delivered{0};
+        mutex mtx;
+        condition_variable wake;
+        mutex spillMutex;
+        deque<FeedbackEvent> spill;
+        atomic<size_t> spilled{0};
+        thread worker;
+        Lane* nextRetired = nullptr;
+        uint64_t retiredEpoch = 0;
+        Lane(shared_ptr<FeedbackObserver> o, size_t capacity) : observer(move(o)), queue(capacity) {}
+    };
+    size_t capacity;
+    Overflow policy;
+    atomic<Lane*> slots[MaxSubscribers];
+    atomic<uint64_t> epoch{0};
+    atomic<int> readers[2] = {};
+    atomic<Lane*> retired{nullptr};
+    atomic<uint64_t> spillCount{0}, dropCount{0};
+
+    // Held by publish and flush for as long as they may dereference a lane.
+    class ReadGuard {
+        ObserverBus& bus;
+        uint64_t epoch;
+    public:
+        explicit ReadGuard(ObserverBus& b) : bus(b) {
+            while (true) {
+                epoch = bus.epoch.load();
+                bus.readers[epoch & 1]++;
+                if (bus.epoch.load() == epoch) {
+                    return;
+                }
+                bus.readers[epoch & 1]--;
+            }
+        }
+        ~ReadGuard() {
+            bus.readers[epoch & 1]--;
+        }
+    };
+    void retire(Lane* lane) {
+        lane->nextRetired = retired.load();
+        while (!retired.compare_exchange_weak(lane->nextRetired, lane)) {
+        }
+    }
+    // Moves the epoch on if the previous one has no readers left, then frees
+    // every retired lane whose worker is done and that was unlinked at least
+    // two epochs ago. Never waits; lanes not ready yet go back on the list.
+    void reclaim() {
+        uint64_t current = epoch.load();
+        if (readers[(current + 1) & 1].load() == 0) {
+            epoch.compare_exchange_strong(current, current + 1);
+        }
+        Lane* lane = retired.exchange(nullptr);
+        while (lane) {
+            Lane* next = lane->nextRetired;
+            if (lane->finished.load() && epoch.load() >= lane->retiredEpoch + 2) {
+                lane->worker.join();
+                delete lane;
+            } else {
+                retire(lane);
+            }
+            lane = next;
+        }
+    }
+
+    // The ring holds only events older than anything spilled, since publish
+    // stops using it while the overflow list is non-empty.
+    static bool take(Lane& lane, FeedbackEvent& event) {
+        if (lane.queue.tryPop(event)) {
+            return true;
+        }
+        if (lane.spilled.load() == 0) {
+            return false;
+        }
+        lock_guard<mutex> lock(lane.spillMutex);
+        event = move(lane.spill.front());
+        lane.spill.pop_front();
+        lane.spilled--;
+        return true;
+    }
+    static void run(Lane& lane) {
+        FeedbackEvent event;
+        while (true) {
+            if (take(lane, event)) {
+                lane.observer->onFeedbackReceived(event.productId, event.rating, event.user, event.comments);
+                lane.delivered++;
+                continue;
+            }
+            if (!lane.active.load()) {
+                lane.finished.store(true);
+                return;
+            }
+            unique_lock<mutex> lock(lane.mtx);
+            lane.sleeping.store(true);
+            lane.wake.wait_for(lock, chrono::milliseconds(1));
+            lane.sleeping.store(false);
+        }
+    }
+public:
+    explicit ObserverBus(size_t capacityPerObserver = 65536, Overflow overflow = SPILL)
+        : capacity(capacityPerObserver), policy(overflow) {
+        for (auto& slot : slots) {
+            slot.store(nullptr);
+        }
+    }
+    ~ObserverBus() {
+        for (int i = 0; i < MaxSubscribers; i++) {
+            unsubscribe(i);
+        }
+        while (retired.load()) {
+            reclaim();
+            this_thread::yield();
+        }
+    }
+    // Returns a subscription id, or -1 if the table is full.
+    int subscribe(shared_ptr<FeedbackObserver> observer) {
+        reclaim();
+        Lane* lane = new Lane(move(observer), capacity);
+        lane->worker = thread([lane] { run(*lane); });
+        for (int i = 0; i < MaxSubscribers; i++) {
+            Lane* expected = nullptr;
+            if (slots[i].compare_exchange_strong(expected, lane)) {
+                return i;
+            }
+        }
+        lane->active.store(false);
+        lane->worker.join();
+        delete lane;
+        return -1;
+    }
+    // Stops delivery to one subscriber once its queue has drained. Returns at
+    // once; the lane is freed by a later subscribe, unsubscribe or the
+    // destructor.
+    void unsubscribe(int id) {
+        if (id < 0 || id >= MaxSubscribers) {
+            return;
+        }
+        Lane* lane = slots[id].exchange(nullptr);
+        if (lane) {
+            lane->active.store(false);
+            lane->wake.notify_one();
+            lane->retiredEpoch = epoch.load();
+            retire(lane);
+        }
+        reclaim();
+    }
+    void publish(int productId, int rating, User* user, const string& comments) {
+        ReadGuard guard(*this);
+        for (auto& slot : slots) {
+            Lane* lane = slot.load(memory_order_acquire);
+            if (!lane) {
+                continue;
+            }
+            FeedbackEvent event{productId, rating, user, comments};
+            if (lane->spilled.load() != 0 || !lane->queue.tryPush(move(event))) {
+                if (policy == DROP) {
+                    dropCount++;
+                    continue;
+                }
+                lock_guard<mutex> lock(lane->spillMutex);
+                lane->spill.push_back(move(event));
+                lane->spilled++;
+                spillCount++;
+            }
+            lane->published++;
+            if (lane->sleeping.load()) {
+                lane->wake.notify_one();
+            }
+        }
+    }
+    // Waits until every subscriber has handled everything published so far.
+    void flush() {
+        ReadGuard guard(*this);
+        for (auto& slot : slots) {
+            Lane* lane = slot.load(memory_order_acquire);
+            while (lane && lane->active.load() && lane->delivered.load() < lane->published.load()) {
+                this_thread::yield();
+            }
+        }
+    }
+    // Events that found a subscriber's queue full, summed over subscribers.
+    uint64_t spilledCount() const {
+        return spillCount.load();
+    }
+    uint64_t droppedCount() const {
+        return dropCount.load();
+    }
+};
+
+// Decides whether a notification may go out: a per-user token bucket caps
+// how many a user gets, and a pair of rotating Bloom filters remembers which
+// (user, message) pairs were sent in the current and previous window so
+// repeats are dropped. Buckets sit in a flat open-addressing table keyed by
+// user id; the filters are fixed-size bitsets. Not thread-safe: give each
+// sending thread its own guard.
+class NotificationGuard {
+public:
+    enum Verdict {
+        SEND,
+        RATE_LIMITED,
+        DUPLICATE
+    };
+    struct Limits {
+        double burst = 3;          // notifications a user can get back to back
+        double perHour = 6;        // steady refill rate
+        uint32_t dedupWindowMs = 3600000;
+        int filterBits = 24;       // each filter is 2^filterBits bits
+    };
+private:
+    struct Bucket {
+        int32_t userId;
+        float tokens;
+        uint32_t lastMs;
+    };
+    static const int32_t EmptyKey = INT32_MIN;
+    Limits limits;
+    vector<Bucket> buckets;
+    size_t used = 0;
+    vector<uint64_t> filters[2]; // [current, previous]
+    uint32_t windowStartMs = 0;
+    uint64_t suppressed[3] = {};
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        return x ^ (x >> 33);
+    }
+    Bucket& bucketFor(int32_t userId, uint32_t nowMs) {
+        if ((used + 1) * 2 > buckets.size()) {
+            vector<Bucket> old(max<size_t>(1024, buckets.size() * 2), Bucket{EmptyKey, 0, 0});
+            old.swap(buckets);
+            used = 0;
+            for (auto& b : old) {
+                if (b.userId != EmptyKey) {
+                    place(b);
+                }
+            }
+        }
+        size_t mask = buckets.size() - 1;
+        for (size_t i = mix((uint32_t)userId) & mask;; i = (i + 1) & mask) {
+            if (buckets[i].userId == userId) {
+                return buckets[i];
+            }
+            if (buckets[i].userId == EmptyKey) {
+                buckets[i] = {userId, (float)limits.burst, nowMs};
+                used++;
+                return buckets[i];
+            }
+        }
+    }
+    void place(const Bucket& b) {
+        size_t mask = buckets.size() - 1;
+        size_t i = mix((uint32_t)b.userId) & mask;
+        while (buckets[i].userId != EmptyKey) {
+            i = (i + 1) & mask;
+        }
+        buckets[i] = b;
+        used++;
+    }
+    bool seen(const vector<uint64_t>& filter, uint64_t h) const {
+        uint64_t mask = ((uint64_t)1 << limits.filterBits) - 1;
+        for (uint64_t k = 0; k < 3; k++) {
+            uint64_t bit = ((h >> 32) + k * (h | 1)) & mask;
+            if (!(filter[bit >> 6] & (1ULL << (bit & 63)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static uint64_t hashOf(int userId, const string& message) {
+        return mix(hash<string>()(message) ^ mix((uint64_t)(uint32_t)userId));
+    }
+    void remember(uint64_t h) {
+        uint64_t mask = ((uint64_t)1 << limits.filterBits) - 1;
+        for (uint64_t k = 0; k < 3; k++) {
+            uint64_t bit = ((h >> 32) + k * (h | 1)) & mask;
+            filters[0][bit >> 6] |= 1ULL << (bit & 63);
+        }
+    }
+public:
+    NotificationGuard() : NotificationGuard(Limits()) {}
+    explicit NotificationGuard(Limits l) : limits(l) {
+        limits.filterBits = min(max(limits.filterBits, 10), 32);
+        for (auto& f : filters) {
+            f.assign(((size_t)1 << limits.filterBits) / 64, 0);
+        }
+    }
+    static uint32_t nowMs() {
+        return (uint32_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    // Decides without spending anything; call record() once the notification
+    // has actually gone out, so a send that fails downstream costs no token
+    // and is not remembered as sent.
+    Verdict check(int userId, const string& message, uint32_t now = nowMs()) {
+        uint32_t elapsed = now - windowStartMs;
+        if (elapsed >= limits.dedupWindowMs) {
+            // One rotation per elapsed window: after an idle gap of two or
+            // more, nothing remembered is recent enough to keep.
+            filters[1].swap(filters[0]);
+            fill(filters[0].begin(), filters[0].end(), 0);
+            if (elapsed / limits.dedupWindowMs >= 2) {
+                fill(filters[1].begin(), filters[1].end(), 0);
+            }
+            windowStartMs = now;
+        }
+        uint64_t h = hashOf(userId, message);
+        if (seen(filters[0], h) || seen(filters[1], h)) {
+            suppressed[DUPLICATE]++;
+            return DUPLICATE;
+        }
+        Bucket& b = bucketFor(userId, now);
+        b.tokens = min((float)limits.burst, b.tokens + (float)((now - b.lastMs) * limits.perHour / 3600000.0));
+        b.lastMs = now;
+        if (b.tokens < 1) {
+            suppressed[RATE_LIMITED]++;
+            return RATE_LIMITED;
+        }
+        return SEND;
+    }
+    // Commits a SEND from check(): spends the user's token and remembers the message.
+    void record(int userId, const string& message, uint32_t now = nowMs()) {
+        Bucket& b = bucketFor(userId, now);
+        b.tokens = max(0.0f, b.tokens - 1);
+        remember(hashOf(userId, message));
+    }
+    uint64_t suppressedCount(Verdict why) const {
+        return suppressed[why];
+    }
+    size_t memoryBytes() const {
+        return buckets.capacity() * sizeof(Bucket) + 2 * filters[0].capacity() * sizeof(uint64_t);
+    }
+};
+
+// Sends through the dispatcher when one is attached, otherwise synchronously.
+// Returns false if the guard suppressed the notification or it could not be
+// handed off; only a notification that went out counts against the guard.
+bool sendNotification(NotificationDispatcher* dispatcher, NotificationGuard* guard, User* user, string message) {
+    uint32_t now = NotificationGuard::nowMs();
+    if (guard && guard->check(user->getId(), message, now) != NotificationGuard::SEND) {
+        return false;
+    }
+    if (dispatcher) {
+        if (!dispatcher->notify(user->getNotificationMethod(), user, message)) {
+            return false;
+        }
+    } else {
+        auto notification = NotificationFactory::createNotification(user->getNotificationMethod(), message, user);
+        if (!notification) {
+            return false;
+        }
+        notification->sendNotification();
+    }
+    if (guard) {
+        guard->record(user->getId(), message, now);
+    }
+    return true;
+}
+
 class CRMService : public FeedbackObserver {
+private:
+    shared_ptr<NotificationDispatcher> dispatcher;
+    shared_ptr<NotificationGuard> guard;
+
 public:
-    void onFeedbackReceived(int productId, int rating, User* user, string comments) override {
-        user->updateFeedback(productId, rating, comments);
+    CRMService(shared_ptr<NotificationDispatcher> d = nullptr, shared_ptr<NotificationGuard> g = nullptr)
+        : dispatcher(d), guard(g) {}
+    void onFeedbackReceived(int /*productId*/, int rating, User* user, const string& /*comments*/) override {
         if (rating <= 7) {
             cout << "[CRM] Issue detected! Sending survey to user..." << endl;
-            auto notification = NotificationFactory::createNotification(user->getNotificationMethod(), 
-            "We're sorry! Please share your issue.", user);
-            notification->sendNotification();
+            if (!sendNotification(dispatcher.get(), guard.get(), user, "We're sorry! Please share your issue.")) {
+                cout << "[CRM] Survey not sent: suppressed or dropped." << endl;
+            }
         }
     }
 };
@@ -101,20 +947,53 @@ public:
 class FeedbackService {
 private:
     vector<shared_ptr<FeedbackObserver>> observers;
+    shared_ptr<NotificationDispatcher> dispatcher;
+    shared_ptr<RatingAggregator> aggregator;
+    shared_ptr<ObserverBus> bus;
+    shared_ptr<FeedbackStore> store;
+    shared_ptr<NotificationGuard> guard;
 
 public:
+    FeedbackService(shared_ptr<NotificationDispatcher> d = nullptr) : dispatcher(d) {}
+
     void registerObserver(shared_ptr<FeedbackObserver> observer) {
         observers.push_back(observer);
     }
 
+    void attachAggregator(shared_ptr<RatingAggregator> ratings) {
+        aggregator = ratings;
+    }
+
+    void attachStore(shared_ptr<FeedbackStore> feedbackStore) {
+        store = feedbackStore;
+    }
+
+    // Used from the thread that calls requestFeedback only.
+    void attachNotificationGuard(shared_ptr<NotificationGuard> notificationGuard) {
+        guard = notificationGuard;
+    }
+
+    // Observers subscribed on the bus run on their own workers instead of the ingest thread.
+    void attachObserverBus(shared_ptr<ObserverBus> observerBus) {
+        bus = observerBus;
+    }
+
     void requestFeedback(User* user, int productId) {
-        auto notification = NotificationFactory::createNotification(user->getNotificationMethod(),
-        "Please rate your order (1-10):", user);
-        notification->sendNotification();
+        sendNotification(dispatcher.get(), guard.get(), user, "Please rate your order (1-10):");
     }
 
-    void storeFeedback(int productId, int rating, User* user, string comments) {
+    void storeFeedback(int productId, int rating, User* user, const string& comments) {
+        if (aggregator) {
+            aggregator->record(productId, user->getRating(productId), rating);
+        }
         user->updateFeedback(productId, rating, comments);
+        if (store) {
+            store->append(productId, user->getId(), rating, comments,
+                          (uint32_t)chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count());
+        }
+        if (bus) {
+            bus->publish(productId, rating, user, comments);
+        }
         for (auto& obs : observers) {
             obs->onFeedbackReceived(productId, rating, user, comments);
         }
@@ -133,15 +1012,260 @@ public:
     }
 };
 
-int main() {
+void benchmarkDispatcher() {
+    const int producers = 4, perProducer = 500000;
+    User user("Bench", 1, "bench@example.com", "0", "Whatsapp");
+    for (auto policy : {NotificationDispatcher::BLOCK, NotificationDispatcher::DROP}) {
+        NotificationDispatcher dispatcher(8192, policy);
+        for (const char* type : {"Whatsapp", "Email", "Stub"}) {
+            dispatcher.registerChannel(type, make_unique<StubSink>());
+        }
+        dispatcher.start();
+        const char* types[] = {"Whatsapp", "Email", "Stub"};
+        vector<vector<float>> latencies(producers);
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (int p = 0; p < producers; p++) {
+            pool.emplace_back([&, p] {
+                latencies[p].reserve(perProducer);
+                for (int i = 0; i < perProducer; i++) {
+                    auto before = chrono::steady_clock::now();
+                    dispatcher.notify(types[i % 3], &user, "Please rate your order (1-10):");
+                    latencies[p].push_back(chrono::duration<float, nano>(chrono::steady_clock::now() - before).count());
+                }
+            });
+        }
+        for (auto& th : pool) {
+            th.join();
+        }
+        dispatcher.flush();
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        dispatcher.stop();
+        vector<float> all;
+        for (auto& l : latencies) {
+            all.insert(all.end(), l.begin(), l.end());
+        }
+        sort(all.begin(), all.end());
+        auto stats = dispatcher.stats();
+        cout << (policy == NotificationDispatcher::BLOCK ? "block" : "drop ") << ": enqueue p50 " << all[all.size() / 2]
+             << " ns, p99 " << all[all.size() * 99 / 100] << " ns, " << (long long)(stats.delivered / secs)
+             << " delivered/s, " << stats.dropped << " dropped, " << (double)stats.delivered / max<uint64_t>(1, stats.batches)
+             << " per batch\n";
+    }
+}
+
+void benchmarkRatingAggregation() {
+    const int products = 1000000;
+    const long long events = 100000000;
+    RatingAggregator ratings;
+    ratings.reserve(products);
+    mt19937 rng(17);
+    auto start = chrono::steady_clock::now();
+    for (long long e = 0; e < events; e++) {
+        uint32_t r = rng();
+        // Skew ratings towards the top like real feedback: 1-10 with more 8-10s.
+        int rating = min(10, 1 + (int)(r % 7) + (int)((r >> 8) % 4));
+        ratings.record(100000 + (int)((r >> 12) % products), -1, rating);
+    }
+    double ingestSecs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const int queries = 1000000;
+    double checksum = 0;
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        int product = 100000 + (int)(rng() % products);
+        checksum += ratings.average(product) + ratings.quantile(product, 0.9);
+    }
+    double queryNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / queries;
+    cout << "ingest " << events << " ratings: " << (long long)(events / ingestSecs) << " events/s; "
+         << ratings.products() << " products, " << ratings.memoryBytes() / ratings.products() << " bytes/product; "
+         << "avg+p90 query " << queryNs << " ns (" << checksum << ")\n";
+}
+
+// Stands in for a CRM call that takes a while; also checks it sees events in order.
+class SlowObserver : public FeedbackObserver {
+public:
+    atomic<int> handled{0};
+    atomic<bool> inOrder{true};
+    int lastProduct = -1;
+    void onFeedbackReceived(int productId, int /*rating*/, User* /*user*/, const string& /*comments*/) override {
+        if (productId <= lastProduct) {
+            inOrder = false;
+        }
+        lastProduct = productId;
+        auto until = chrono::steady_clock::now() + chrono::microseconds(20);
+        while (chrono::steady_clock::now() < until) {
+        }
+        handled++;
+    }
+};
+
+class CountingObserver : public FeedbackObserver {
+public:
+    atomic<int> handled{0};
+    void onFeedbackReceived(int /*productId*/, int /*rating*/, User* /*user*/, const string& /*comments*/) override {
+        handled++;
+    }
+};
+
+void benchmarkObserverBus() {
+    const int events = 50000;
+    User user("Bench", 1, "bench@example.com", "0", "Stub");
+    {
+        FeedbackService service;
+        auto slow = make_shared<SlowObserver>();
+        service.registerObserver(slow);
+        service.registerObserver(make_shared<CountingObserver>());
+        auto start = chrono::steady_clock::now();
+        for (int e = 0; e < events; e++) {
+            service.storeFeedback(e, 1 + e % 10, &user, "On time.");
+        }
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "inline observers: " << (long long)(events / secs) << " feedback/s ingest\n";
+    }
+    // Queues far smaller than the burst, so the slow observer overflows.
+    const size_t capacity = 4096;
+    for (ObserverBus::Overflow overflow : {ObserverBus::SPILL, ObserverBus::DROP}) {
+        FeedbackService service;
+        auto bus = make_shared<ObserverBus>(capacity, overflow);
+        service.attachObserverBus(bus);
+        auto slow = make_shared<SlowObserver>();
+        auto fast = make_shared<CountingObserver>();
+        bus->subscribe(slow);
+        bus->subscribe(fast);
+        // Churn a third subscriber while ingesting to exercise lock-free (un)subscribe.
+        atomic<bool> done{false};
+        thread churn([&] {
+            while (!done.load()) {
+                int id = bus->subscribe(make_shared<CountingObserver>());
+                this_thread::sleep_for(chrono::milliseconds(5));
+                bus->unsubscribe(id);
+            }
+        });
+        auto start = chrono::steady_clock::now();
+        for (int e = 0; e < events; e++) {
+            service.storeFeedback(e, 1 + e % 10, &user, "On time.");
+        }
+        double ingestSecs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        done = true;
+        churn.join();
+        bus->flush();
+        double drainSecs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "observer bus (" << (overflow == ObserverBus::SPILL ? "spill" : "drop") << ", " << capacity << "-slot queues): "
+             << (long long)(events / ingestSecs) << " feedback/s ingest, slow observer caught up after "
+             << drainSecs << " s, " << slow->handled << "/" << fast->handled << " delivered, "
+             << bus->spilledCount() << " spilled, " << bus->droppedCount() << " dropped, "
+             << (slow->inOrder ? "in order" : "OUT OF ORDER") << "\n";
+    }
+}
+
+void benchmarkFeedbackStore() {
+    const int records = 2000000;
+    const vector<string> words = {"delivery", "late", "cold", "food", "great", "taste", "driver", "rude", "fast",
+                                  "packaging", "spilled", "fresh", "order", "missing", "item", "hot", "tasty",
+                                  "slow", "friendly", "wrong", "portion", "small", "excellent", "price", "again"};
+    FeedbackStore store;
+    vector<string> plain; // the same comments as separate strings, for the scan baseline
+    plain.reserve(records);
+    mt19937 rng(23);
+    for (int i = 0; i < records; i++) {
+        string comment;
+        int n = 3 + rng() % 6;
+        for (int w = 0; w < n; w++) {
+            comment += (w ? " " : "") + words[rng() % words.size()] + (rng() % 50 == 0 ? " #" + to_string(rng() % 100000) : "");
+        }
+        comment += ".";
+        store.append(rng() % 1000000, rng() % 5000000, 1 + rng() % 10, comment, 1700000000 + i);
+        plain.push_back(comment);
+    }
+    size_t hits = 0;
+    auto start = chrono::steady_clock::now();
+    const int queries = 20;
+    for (int q = 0; q < queries; q++) {
+        hits += store.search("late cold", 1, 3).size();
+    }
+    double indexMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / queries;
+    start = chrono::steady_clock::now();
+    size_t scanHits = 0;
+    for (int i = 0; i < records; i++) {
+        if (store.rating(i) <= 3 && plain[i].find("late") != string::npos && plain[i].find("cold") != string::npos) {
+            scanHits++;
+        }
+    }
+    double scanMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << records << " feedback records: " << (double)store.memoryBytes() / records << " bytes/record; "
+         << "\"late cold\" with rating <= 3: index " << indexMs << " ms, scan " << scanMs << " ms (" << hits / queries
+         << " / " << scanHits << " hits)\n";
+}
+
+void benchmarkNotificationGuard() {
+    const int users = 2000000, notifications = 20000000;
+    vector<string> messages;
+    for (int i = 0; i < 64; i++) {
+        messages.push_back("Please rate your order #" + to_string(1000 + i) + " (1-10):");
+    }
+    // A replayed day: times are spread over 24h and a tenth of the users are
+    // heavy raters who account for half of the traffic.
+    mt19937 rng(31);
+    vector<int> userIds(notifications);
+    vector<uint8_t> messageIds(notifications);
+    vector<uint32_t> times(notifications);
+    for (int i = 0; i < notifications; i++) {
+        userIds[i] = rng() % 2 ? rng() % (users / 10) : rng() % users;
+        messageIds[i] = rng() % 4 ? rng() % 4 : rng() % messages.size();
+        times[i] = (uint32_t)((uint64_t)i * 86400000 / notifications);
+    }
+    NotificationGuard guard;
+    uint64_t sent = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < notifications; i++) {
+        if (guard.check(userIds[i], messages[messageIds[i]], times[i]) == NotificationGuard::SEND) {
+            guard.record(userIds[i], messages[messageIds[i]], times[i]);
+            sent++;
+        }
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / notifications;
+    cout << "guard: " << ns << " ns/notification, " << sent << " sent, "
+         << guard.suppressedCount(NotificationGuard::DUPLICATE) << " duplicates and "
+         << guard.suppressedCount(NotificationGuard::RATE_LIMITED) << " rate-limited suppressed, "
+         << guard.memoryBytes() / (1 << 20) << " MB\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkNotificationGuard();
+        benchmarkFeedbackStore();
+        benchmarkObserverBus();
+        benchmarkRatingAggregation();
+        benchmarkDispatcher();
+        return 0;
+    }
     User user("Anand Tiwari", 101, "anand@example.com", "+91-9260935205", "Whatsapp");
-    auto feedbackService = make_shared<FeedbackService>();
-    auto crmService = make_shared<CRMService>();
-    feedbackService->registerObserver(crmService);
+    auto dispatcher = make_shared<NotificationDispatcher>();
+    dispatcher->registerChannel("Whatsapp", make_unique<WhatsappSink>());
+    dispatcher->registerChannel("Email", make_unique<EmailSink>());
+    dispatcher->start();
+    auto feedbackService = make_shared<FeedbackService>(dispatcher);
+    auto crmService = make_shared<CRMService>(dispatcher, make_shared<NotificationGuard>());
+    auto ratings = make_shared<RatingAggregator>();
+    feedbackService->attachAggregator(ratings);
+    auto observerBus = make_shared<ObserverBus>();
+    feedbackService->attachObserverBus(observerBus);
+    observerBus->subscribe(crmService);
+    auto store = make_shared<FeedbackStore>();
+    feedbackService->attachStore(store);
     auto orderService = make_shared<OrderService>(feedbackService);
     int productId = 123;
     orderService->deliverOrder(&user, productId);
     feedbackService->storeFeedback(productId, 5, &user, "Late delivery.");
+    feedbackService->storeFeedback(productId + 1, 4, &user, "Cold food, late again.");
+    observerBus->flush();
+    dispatcher->flush();
     user.getFeedback(productId);
+    cout << "[Ratings] Product " << productId << " average " << ratings->average(productId)
+         << ", p90 " << ratings->quantile(productId, 0.9) << " over " << ratings->count(productId) << " ratings" << endl;
+    for (uint32_t id : store->search("late", 1, 5)) {
+        cout << "[Search] Low rating mentioning 'late': " << store->comment(id) << endl;
+    }
     return 0;
 }
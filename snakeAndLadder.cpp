@@ -16,11 +16,108 @@ class Player {
         }
 };
 
+// xoshiro256** (Blackman & Vigna): 32 bytes of state, a few cycles per
+// 64-bit output. Seeded through splitmix64 so any seed, even 0, is fine.
+class Xoshiro256 {
+    private:
+        uint64_t state[4];
+        static uint64_t rotl(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+    public:
+        explicit Xoshiro256(uint64_t seed) {
+            for (auto &word : state) {
+                seed += 0x9e3779b97f4a7c15ULL;
+                uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                word = z ^ (z >> 31);
+            }
+        }
+        uint64_t next() {
+            uint64_t result = rotl(state[1] * 5, 7) * 9;
+            uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+};
+
+// Throws `numberOfDice` six-sided dice and returns their sum, so two dice
+// give 7 far more often than 2. Each Dice owns its generator: give every
+// game or thread its own, and pass a seed for reproducible runs.
 class Dice {
     private:
         int numberOfDice;
+        Xoshiro256 gen;
+        uint32_t spare = 0;
+        bool hasSpare = false;
+        // One face from 32 random bits, by Lemire's multiply-shift with
+        // rejection so every face is exactly equally likely.
+        static int face(uint32_t bits, Xoshiro256 &gen) {
+            uint64_t product = (uint64_t)bits * 6;
+            if ((uint32_t)product < 6) {
+                const uint32_t threshold = (uint32_t)-6 % 6;
+                while ((uint32_t)product < threshold) {
+                    product = (uint64_t)(uint32_t)gen.next() * 6;
+                }
+            }
+            return 1 + (int)(product >> 32);
+        }
+        int oneDie() {
+            if (hasSpare) {
+                hasSpare = false;
+                return face(spare, gen);
+            }
+            uint64_t bits = gen.next();
+            spare = (uint32_t)(bits >> 32);
+            hasSpare = true;
+            return face((uint32_t)bits, gen);
+        }
     public:
-        Dice(int n) : numberOfDice(n) {};
+        Dice(int n) : Dice(n, random_device{}()) {};
+        Dice(int n, uint64_t seed) : numberOfDice(n), gen(seed) {};
+        int getNumberOfDice() {
+            return numberOfDice;
+        }
+        int rollDice() {
+            int total = 0;
+            for (int i = 0; i < numberOfDice; i++) {
+                total += oneDie();
+            }
+            return total;
+        }
+        // Fills `out` with `count` throws.
+        void rollBatch(int *out, size_t count) {
+            if (numberOfDice == 1) {
+                size_t i = 0;
+                for (; i + 1 < count; i += 2) {
+                    uint64_t bits = gen.next();
+                    out[i] = face((uint32_t)bits, gen);
+                    out[i + 1] = face((uint32_t)(bits >> 32), gen);
+                }
+                if (i < count) {
+                    out[i] = oneDie();
+                }
+                return;
+            }
+            for (size_t i = 0; i < count; i++) {
+                out[i] = rollDice();
+            }
+        }
+};
+
+// The original dice: a fresh random_device and mt19937 on every throw, and a
+// flat n..6n range. Kept as the baseline for benchmarkDice.
+class ReferenceDice {
+    private:
+        int numberOfDice;
+    public:
+        ReferenceDice(int n) : numberOfDice(n) {};
         int rollDice() {
             random_device rd;
             mt19937 gen(rd());
@@ -43,26 +140,141 @@ class Jump {
         }
 };
 
+// Where a turn that ends on each square really finishes, after the ladders
+// and then the snakes are applied in the order they were given.
+vector<int> buildJumpTable(int lastSquare, vector<Jump> &ladders, vector<Jump> &snakes) {
+    vector<int> destination(lastSquare + 1);
+    for (int square = 0; square <= lastSquare; square++) {
+        int at = square;
+        for (auto &ladder : ladders) {
+            if (ladder.getStartPoint() == at) {
+                at = ladder.getEndpoint();
+            }
+        }
+        for (auto &snake : snakes) {
+            if (snake.getStartPoint() == at) {
+                at = snake.getEndpoint();
+            }
+        }
+        destination[square] = at;
+    }
+    return destination;
+}
+
 class Board {
     private:
+        static const int LastSquare = 100;
+        static const long long TurnLimit = 10000000;
         Dice dice;
+        vector<Player> players;      // by seat, in turn order
+        vector<int> startPositions;  // by seat
+        vector<int> positions;       // by seat
+        vector<int> active;          // seats still playing, in turn order
+        vector<int> destination;     // square -> square after jumps
+        ostream *log = &cout;
+    public:
+        Board(Dice d, queue<Player> n, vector<Jump> s, vector<Jump> l, map<int, int> mp) :
+        dice(d), destination(buildJumpTable(LastSquare, l, s)) {
+            while (!n.empty()) {
+                players.push_back(n.front());
+                startPositions.push_back(mp[n.front().getId()]);
+                n.pop();
+            }
+            reset();
+        };
+        void setLog(ostream *out) {
+            log = out;
+        }
+        int seatCount() {
+            return (int)players.size();
+        }
+        int lastSquare() {
+            return LastSquare;
+        }
+        int getNumberOfDice() {
+            return dice.getNumberOfDice();
+        }
+        // Puts every player back on their starting square.
+        void reset() {
+            positions = startPositions;
+            active.resize(players.size());
+            for (int seat = 0; seat < (int)players.size(); seat++) {
+                active[seat] = seat;
+            }
+        }
+        // Plays until one player is left, or `maxTurns` turns have passed on a
+        // board where players can get stuck, and returns the number of turns.
+        // `roll` supplies each throw; the loop itself does not allocate.
+        // `landed(seat, square)` sees every move after jumps, including the
+        // finishing one onto the last square, and ends the game early by
+        // returning false.
+        template<typename Roll, typename Landed>
+        long long play(Roll &&roll, Landed &&landed, long long maxTurns = TurnLimit) {
+            long long turns = 0;
+            size_t turn = 0;
+            while (active.size() > 1 && turns < maxTurns) {
+                if (turn >= active.size()) {
+                    turn = 0;
+                }
+                int seat = active[turn];
+                int nextPos = positions[seat] + roll();
+                turns++;
+                if (nextPos > LastSquare) {
+                    turn++;
+                    continue;
+                }
+                nextPos = destination[nextPos];
+                bool keepPlaying = landed(seat, nextPos);
+                if (nextPos == LastSquare) {
+                    if (log) {
+                        *log << "Player with player id " << players[seat].getId() << "Name " << players[seat].getName() << "won" << endl;
+                    }
+                    active.erase(active.begin() + turn);
+                } else {
+                    positions[seat] = nextPos;
+                    turn++;
+                }
+                if (!keepPlaying) {
+                    break;
+                }
+            }
+            return turns;
+        }
+        template<typename Roll>
+        long long play(Roll &&roll) {
+            return play(roll, [](int, int) { return true; });
+        }
+        void startGame() {
+            long long turns = play([this]() { return dice.rollDice(); });
+            if (active.size() > 1 && log) {
+                *log << "Game stopped after " << turns << " turns with " << active.size() << " players still playing" << endl;
+            }
+        }
+};
+
+// The original turn loop: scans every jump each turn and cycles players
+// through a queue by value. Kept as the baseline for benchmarkTurnLoop.
+class ReferenceBoard {
+    private:
         queue<Player> nextTurn;
         vector<Jump> snakes;
         vector<Jump> ladders;
         map<int, int> playerPosition;
     public:
-        Board(Dice d, queue<Player> n, vector<Jump> s, vector<Jump> l, map<int, int> mp) :
-        dice(d), nextTurn(n), snakes(s), ladders(l), playerPosition(mp) {};
-        void startGame() {
+        ReferenceBoard(queue<Player> n, vector<Jump> s, vector<Jump> l, map<int, int> mp) :
+        nextTurn(n), snakes(s), ladders(l), playerPosition(mp) {};
+        template<typename Roll>
+        long long play(Roll &&roll) {
+            long long turns = 0;
             while(nextTurn.size() > 1) {
                 auto p = nextTurn.front();
                 int currentPos = playerPosition[p.getId()];
                 nextTurn.pop();
-                int nextPos = currentPos + dice.rollDice();
+                int nextPos = currentPos + roll();
+                turns++;
                 if (nextPos < 100)
                 playerPosition[p.getId()] = nextPos;
                 else if (nextPos == 100) {
-                    cout << "Player with player id " << p.getId() << "Name " << p.getName() << "won" << endl;
                     continue;
                 }
                 for (auto &ladder : ladders) {
@@ -76,6 +288,555 @@ class Board {
                     }
                 }
                 nextTurn.push(p);
-            } 
+            }
+            return turns;
+        }
+};
+
+// What a batch of simulated games looked like. A game here ends when the
+// first player reaches the last square.
+struct SimulationReport {
+    static const int MaxTurns = 1000;  // longer games share the last bucket
+    long long games = 0;
+    long long unfinished = 0;          // stopped at the turn limit; also in the last bucket
+    vector<long long> gamesByLength;   // turns until the first player finished
+    vector<long long> winsBySeat;
+    vector<long long> visits;          // landings per square, after jumps
+    double seconds = 0;
+
+    SimulationReport(int seats = 0, int squares = 0) :
+    gamesByLength(MaxTurns + 1), winsBySeat(seats), visits(squares + 1) {};
+
+    void merge(const SimulationReport &other) {
+        games += other.games;
+        unfinished += other.unfinished;
+        for (size_t i = 0; i < gamesByLength.size(); i++) {
+            gamesByLength[i] += other.gamesByLength[i];
+        }
+        for (size_t i = 0; i < winsBySeat.size(); i++) {
+            winsBySeat[i] += other.winsBySeat[i];
+        }
+        for (size_t i = 0; i < visits.size(); i++) {
+            visits[i] += other.visits[i];
+        }
+    }
+    double meanLength() {
+        double total = 0;
+        for (size_t turns = 0; turns < gamesByLength.size(); turns++) {
+            total += (double)turns * gamesByLength[turns];
+        }
+        return games ? total / games : 0;
+    }
+    // Smallest length that at least `fraction` of the games finished within.
+    int lengthPercentile(double fraction) {
+        long long seen = 0;
+        for (size_t turns = 0; turns < gamesByLength.size(); turns++) {
+            seen += gamesByLength[turns];
+            if (seen >= fraction * games) {
+                return (int)turns;
+            }
+        }
+        return MaxTurns;
+    }
+};
+
+// Plays many independent games of a board on several threads. Every thread
+// copies the board and gets its own Dice seeded from `seed` and its index,
+// so a run is reproducible for a given seed and thread count. Threads keep
+// private tallies and merge them once at the end. A game nobody has won
+// after `turnLimit` turns, which only happens on boards where a player can
+// get stuck, is stopped and reported as unfinished.
+class MonteCarlo {
+    private:
+        Board prototype;
+        long long turnLimit;
+    public:
+        MonteCarlo(Board board, long long turnLimit = 100 * SimulationReport::MaxTurns) :
+        prototype(board), turnLimit(turnLimit) {
+            prototype.setLog(nullptr);
+        };
+        SimulationReport run(long long games, int threads, uint64_t seed) {
+            if (threads <= 0) {
+                throw invalid_argument("MonteCarlo::run needs at least one thread");
+            }
+            int seats = prototype.seatCount(), squares = prototype.lastSquare();
+            vector<SimulationReport> partial(threads, SimulationReport(seats, squares));
+            vector<thread> workers;
+            auto begin = chrono::steady_clock::now();
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    Board board = prototype;
+                    Dice dice(board.getNumberOfDice(), seed * 0x9e3779b97f4a7c15ULL + t);
+                    SimulationReport &report = partial[t];
+                    long long share = games / threads + (t < games % threads ? 1 : 0);
+                    for (long long g = 0; g < share; g++) {
+                        board.reset();
+                        bool won = false;
+                        long long turns = board.play([&]() { return dice.rollDice(); }, [&](int seat, int square) {
+                            report.visits[square]++;
+                            if (square == squares) {
+                                report.winsBySeat[seat]++;
+                                won = true;
+                                return false;
+                            }
+                            return true;
+                        }, turnLimit);
+                        if (!won) {
+                            report.unfinished++;
+                            turns = SimulationReport::MaxTurns;
+                        }
+                        report.gamesByLength[min<long long>(turns, SimulationReport::MaxTurns)]++;
+                    }
+                    report.games = share;
+                });
+            }
+            for (auto &worker : workers) {
+                worker.join();
+            }
+            SimulationReport total(seats, squares);
+            for (auto &report : partial) {
+                total.merge(report);
+            }
+            total.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            return total;
+        }
+};
+
+// Exact analysis of a board as an absorbing Markov chain over its squares.
+// One player's square after each turn is the state; a throw moves them with
+// the odds of the dice sum, an overshoot leaves them in place, and the last
+// square absorbs. Players never interact, so games of several players follow
+// from the single-player turn distribution.
+class MarkovAnalysis {
+    private:
+        int lastSquare;
+        vector<int> destination;
+        vector<double> rollOdds;       // by sum of the dice
+        vector<char> canFinish;        // by square; 0 if the last square is unreachable
+        vector<char> surelyFinishes;   // by square; 0 if some path leads to a square that cannot finish
+        vector<double> expected;       // turns to finish, by square
+        vector<double> finishOnTurn;   // P(finishing on exactly turn t), from the start
+        double stuck = 0;              // P(reaching a square that cannot finish)
+        double unfinished = 0;         // mass still playing when the distribution was cut off
+
+        static vector<double> diceSumOdds(int numberOfDice) {
+            vector<double> odds(1, 1.0);
+            for (int die = 0; die < numberOfDice; die++) {
+                vector<double> next(odds.size() + 6, 0.0);
+                for (size_t sum = 0; sum < odds.size(); sum++) {
+                    for (int face = 1; face <= 6; face++) {
+                        next[sum + face] += odds[sum] / 6;
+                    }
+                }
+                odds = next;
+            }
+            return odds;
+        }
+        int step(int square, int roll) {
+            int to = square + roll;
+            return to > lastSquare ? square : destination[to];
+        }
+        void ensureDistribution() {
+            if (finishOnTurn.empty()) {
+                solveDistribution();
+            }
+        }
+    public:
+        MarkovAnalysis(int last, vector<Jump> ladders, vector<Jump> snakes, int numberOfDice) :
+        lastSquare(last), destination(buildJumpTable(last, ladders, snakes)), rollOdds(diceSumOdds(numberOfDice)),
+        canFinish(last + 1, 0), surelyFinishes(last + 1, 1) {
+            // Walk the moves backwards, first from the last square, then from
+            // every square that cannot reach it.
+            vector<vector<int>> from(lastSquare + 1);
+            for (int square = 0; square < lastSquare; square++) {
+                for (int roll = 1; roll < (int)rollOdds.size(); roll++) {
+                    if (rollOdds[roll] > 0) {
+                        from[step(square, roll)].push_back(square);
+                    }
+                }
+            }
+            vector<int> pending = {lastSquare};
+            canFinish[lastSquare] = 1;
+            while (!pending.empty()) {
+                int square = pending.back();
+                pending.pop_back();
+                for (int previous : from[square]) {
+                    if (!canFinish[previous]) {
+                        canFinish[previous] = 1;
+                        pending.push_back(previous);
+                    }
+                }
+            }
+            for (int square = 0; square < lastSquare; square++) {
+                if (!canFinish[square]) {
+                    surelyFinishes[square] = 0;
+                    pending.push_back(square);
+                }
+            }
+            while (!pending.empty()) {
+                int square = pending.back();
+                pending.pop_back();
+                for (int previous : from[square]) {
+                    if (surelyFinishes[previous]) {
+                        surelyFinishes[previous] = 0;
+                        pending.push_back(previous);
+                    }
+                }
+            }
+        };
+
+        // Solves (I - Q) e = 1 by Gaussian elimination on the dense matrix,
+        // over the squares that finish with certainty; from any other square
+        // the expectation is infinite. I - Q is a diagonally dominant
+        // M-matrix, so no pivoting is needed. Zero multipliers are skipped and
+        // each row update stops at the pivot row's last non-zero column, which
+        // keeps most of the dense work out of the inner loop. Memory is n^2
+        // doubles: 800 MB at 10,000 squares.
+        void solveExpected() {
+            vector<int> index(lastSquare, -1), squares;
+            for (int square = 0; square < lastSquare; square++) {
+                if (surelyFinishes[square]) {
+                    index[square] = (int)squares.size();
+                    squares.push_back(square);
+                }
+            }
+            size_t n = squares.size();
+            vector<double> a(n * n, 0.0), b(n, 1.0);
+            vector<int> rowEnd(n);
+            for (size_t i = 0; i < n; i++) {
+                double *row = &a[i * n];
+                row[i] += 1;
+                for (int roll = 1; roll < (int)rollOdds.size(); roll++) {
+                    int to = step(squares[i], roll);
+                    if (to != lastSquare && rollOdds[roll] > 0) {
+                        row[index[to]] -= rollOdds[roll];
+                    }
+                }
+                rowEnd[i] = (int)i;
+                for (size_t j = n; j-- > i;) {
+                    if (row[j] != 0) {
+                        rowEnd[i] = (int)j;
+                        break;
+                    }
+                }
+            }
+            for (size_t k = 0; k < n; k++) {
+                const double *pivotRow = &a[k * n];
+                int end = rowEnd[k];
+                for (size_t i = k + 1; i < n; i++) {
+                    double *row = &a[i * n];
+                    if (row[k] == 0) {
+                        continue;
+                    }
+                    double factor = row[k] / pivotRow[k];
+                    row[k] = 0;
+                    for (int j = (int)k + 1; j <= end; j++) {
+                        row[j] -= factor * pivotRow[j];
+                    }
+                    b[i] -= factor * b[k];
+                    rowEnd[i] = max(rowEnd[i], end);
+                }
+            }
+            for (size_t i = n; i-- > 0;) {
+                const double *row = &a[i * n];
+                double sum = b[i];
+                for (int j = (int)i + 1; j <= rowEnd[i]; j++) {
+                    sum -= row[j] * b[j];
+                }
+                b[i] = sum / row[i];
+            }
+            expected.assign(lastSquare + 1, numeric_limits<double>::infinity());
+            expected[lastSquare] = 0;
+            for (size_t i = 0; i < n; i++) {
+                expected[squares[i]] = b[i];
+            }
+        }
+
+        // Pushes the start distribution through the chain one turn at a time
+        // until less than `tail` of it is still playing (or maxTurns pass).
+        // Mass that lands on a square from which the last square cannot be
+        // reached is set aside as stuck rather than iterated forever.
+        void solveDistribution(int startSquare = 0, double tail = 1e-12, int maxTurns = 1000000) {
+            vector<double> now(lastSquare + 1, 0.0), next(lastSquare + 1, 0.0);
+            finishOnTurn.assign(1, startSquare == lastSquare ? 1 : 0);
+            stuck = canFinish[startSquare] ? 0 : 1;
+            double playing = startSquare == lastSquare || stuck ? 0 : 1;
+            now[startSquare] = playing;
+            for (int turn = 1; turn <= maxTurns && playing > tail; turn++) {
+                fill(next.begin(), next.end(), 0.0);
+                for (int square = 0; square < lastSquare; square++) {
+                    if (now[square] == 0) {
+                        continue;
+                    }
+                    for (int roll = 1; roll < (int)rollOdds.size(); roll++) {
+                        next[step(square, roll)] += now[square] * rollOdds[roll];
+                    }
+                }
+                for (int square = 0; square < lastSquare; square++) {
+                    if (!canFinish[square] && next[square] != 0) {
+                        stuck += next[square];
+                        playing -= next[square];
+                        next[square] = 0;
+                    }
+                }
+                finishOnTurn.push_back(next[lastSquare]);
+                playing -= next[lastSquare];
+                next[lastSquare] = 0;
+                swap(now, next);
+            }
+            unfinished = max(0.0, playing);
+        }
+
+        // Infinite from squares that may never finish. Runs solveExpected
+        // first if it has not been; that costs O(n^3) on a large board.
+        double expectedTurns(int square = 0) {
+            if (expected.empty()) {
+                solveExpected();
+            }
+            return expected[square];
+        }
+        // These and gameOutcome use the last solveDistribution, running it
+        // from the start square with default limits if there was none.
+        vector<double> &turnDistribution() {
+            ensureDistribution();
+            return finishOnTurn;
+        }
+        double unfinishedMass() {
+            ensureDistribution();
+            return unfinished;
+        }
+        double stuckMass() {
+            ensureDistribution();
+            return stuck;
         }
-};
\ No newline at end of file
+        // Exact odds for a game of `seats` players from the start square,
+        // ending when the first one finishes: seat i wins on its m-th turn if
+        // it finishes then, the seats before it have not finished within m
+        // turns and those after it not within m - 1.
+        void gameOutcome(int seats, vector<double> &winBySeat, vector<double> &gameLengthOdds) {
+            ensureDistribution();
+            winBySeat.assign(seats, 0.0);
+            gameLengthOdds.assign(finishOnTurn.size() * seats + 1, 0.0);
+            double stillPlaying = 1 - finishOnTurn[0];  // P(T > m - 1)
+            for (size_t m = 1; m < finishOnTurn.size(); m++) {
+                double after = stillPlaying - finishOnTurn[m];  // P(T > m)
+                for (int seat = 0; seat < seats; seat++) {
+                    double odds = finishOnTurn[m] * pow(after, seat) * pow(stillPlaying, seats - 1 - seat);
+                    winBySeat[seat] += odds;
+                    gameLengthOdds[(m - 1) * seats + seat + 1] += odds;
+                }
+                stillPlaying = after;
+            }
+        }
+};
+
+// The classic Milton Bradley layout.
+vector<Jump> classicLadders() {
+    return {Jump(1, 38), Jump(4, 14), Jump(9, 31), Jump(21, 42), Jump(28, 84), Jump(36, 44), Jump(51, 67), Jump(71, 91), Jump(80, 99)};
+}
+
+vector<Jump> classicSnakes() {
+    return {Jump(16, 6), Jump(47, 26), Jump(49, 11), Jump(56, 53), Jump(62, 19), Jump(64, 60), Jump(87, 24), Jump(93, 73), Jump(95, 75), Jump(98, 78)};
+}
+
+void benchmarkTurnLoop() {
+    const int games = 200000;
+    queue<Player> seats;
+    map<int, int> start;
+    for (int id = 1; id <= 4; id++) {
+        seats.push(Player("P" + to_string(id), id));
+        start[id] = 0;
+    }
+    // Both loops replay the same pre-rolled tape so only the loop is timed.
+    vector<int> tape(1 << 20);
+    mt19937 gen(12345);
+    for (auto &roll : tape) {
+        roll = 1 + gen() % 6;
+    }
+    size_t next = 0;
+    auto roll = [&]() { return tape[next++ & (tape.size() - 1)]; };
+
+    Board board(Dice(1), seats, classicSnakes(), classicLadders(), start);
+    board.setLog(nullptr);
+    long long turns = 0;
+    auto begin = chrono::steady_clock::now();
+    for (int g = 0; g < games; g++) {
+        board.reset();
+        turns += board.play(roll);
+    }
+    double fast = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    next = 0;
+    long long referenceTurns = 0;
+    begin = chrono::steady_clock::now();
+    for (int g = 0; g < games; g++) {
+        ReferenceBoard reference(seats, classicSnakes(), classicLadders(), start);
+        referenceTurns += reference.play(roll);
+    }
+    double slow = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    cout << "turn loop: jump table " << turns / fast / 1e6 << "M turns/s, original " << referenceTurns / slow / 1e6
+         << "M turns/s (" << turns << " vs " << referenceTurns << " turns)" << endl;
+}
+
+void benchmarkDice() {
+    const int referenceRolls = 200000, rolls = 100000000;
+    for (int n : {1, 2}) {
+        ReferenceDice reference(n);
+        long long referenceSum = 0;
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < referenceRolls; i++) {
+            referenceSum += reference.rollDice();
+        }
+        double referenceRate = referenceRolls / chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+        Dice dice(n, 2024);
+        long long sum = 0;
+        vector<long long> histogram(6 * n + 1);
+        begin = chrono::steady_clock::now();
+        for (int i = 0; i < rolls; i++) {
+            int roll = dice.rollDice();
+            sum += roll;
+            histogram[roll]++;
+        }
+        double rate = rolls / chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+        vector<int> batch(4096);
+        long long batchSum = 0;
+        begin = chrono::steady_clock::now();
+        for (int done = 0; done < rolls; done += (int)batch.size()) {
+            dice.rollBatch(batch.data(), batch.size());
+            for (int roll : batch) {
+                batchSum += roll;
+            }
+        }
+        double batchRate = rolls / chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+        int mode = n == 1 ? 6 : 7;
+        cout << "dice x" << n << ": original " << referenceRate / 1e6 << "M rolls/s (mean " << (double)referenceSum / referenceRolls
+             << "), xoshiro " << rate / 1e6 << "M rolls/s (mean " << (double)sum / rolls << ", P(" << mode << ") = "
+             << (double)histogram[mode] / rolls << "), batched " << batchRate / 1e6 << "M rolls/s (mean "
+             << (double)batchSum / rolls << ")" << endl;
+    }
+}
+
+void benchmarkMonteCarlo() {
+    const long long games = 4000000;
+    queue<Player> seats;
+    map<int, int> start;
+    for (int id = 1; id <= 4; id++) {
+        seats.push(Player("P" + to_string(id), id));
+        start[id] = 0;
+    }
+    MonteCarlo simulation(Board(Dice(1), seats, classicSnakes(), classicLadders(), start));
+    int cores = max(1u, thread::hardware_concurrency());
+    SimulationReport report;
+    for (int threads = 1; threads <= max(cores, 8); threads *= 2) {
+        report = simulation.run(games, threads, 7);
+        cout << "monte carlo: " << threads << " threads, " << games / report.seconds / 1e6 << "M games/s" << endl;
+    }
+    cout << "monte carlo: first finish after " << report.meanLength() << " turns on average, p50 " << report.lengthPercentile(0.5)
+         << ", p99 " << report.lengthPercentile(0.99) << ", " << report.unfinished << " unfinished; win probability by seat";
+    for (long long wins : report.winsBySeat) {
+        cout << " " << (double)wins / report.games;
+    }
+    vector<int> squares(report.visits.size() - 1);
+    iota(squares.begin(), squares.end(), 0);
+    sort(squares.begin(), squares.end(), [&](int a, int b) { return report.visits[a] > report.visits[b]; });
+    cout << "; most landed on";
+    for (int i = 0; i < 5; i++) {
+        cout << " " << squares[i] << " (" << (double)report.visits[squares[i]] / report.games << "/game)";
+    }
+    cout << endl;
+}
+
+// `count` ladders and as many snakes with random ends, none sharing a start.
+void randomJumps(int lastSquare, int count, mt19937 &gen, vector<Jump> &ladders, vector<Jump> &snakes) {
+    vector<char> used(lastSquare + 1, 0);
+    used[0] = used[lastSquare] = 1;
+    while ((int)(ladders.size() + snakes.size()) < 2 * count) {
+        int a = 1 + gen() % (lastSquare - 1), b = 1 + gen() % (lastSquare - 1);
+        if (a == b || used[a] || used[b]) {
+            continue;
+        }
+        used[a] = used[b] = 1;
+        bool ladder = (int)ladders.size() < count && ((int)snakes.size() >= count || gen() % 2);
+        (ladder ? ladders : snakes).push_back(Jump(min(a, b) + (ladder ? 0 : max(a, b) - min(a, b)), ladder ? max(a, b) : min(a, b)));
+    }
+}
+
+void benchmarkMarkov() {
+    const int seats = 4;
+    const long long games = 4000000;
+    auto begin = chrono::steady_clock::now();
+    MarkovAnalysis exact(100, classicLadders(), classicSnakes(), 1);
+    exact.solveExpected();
+    exact.solveDistribution();
+    vector<double> winBySeat, lengthOdds;
+    exact.gameOutcome(seats, winBySeat, lengthOdds);
+    double exactSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    double exactLength = 0;
+    for (size_t turns = 0; turns < lengthOdds.size(); turns++) {
+        exactLength += turns * lengthOdds[turns];
+    }
+
+    queue<Player> players;
+    map<int, int> start;
+    for (int id = 1; id <= seats; id++) {
+        players.push(Player("P" + to_string(id), id));
+        start[id] = 0;
+    }
+    MonteCarlo simulation(Board(Dice(1), players, classicSnakes(), classicLadders(), start));
+    SimulationReport report = simulation.run(games, max(1u, thread::hardware_concurrency()), 11);
+    double squares = 0;
+    for (size_t turns = 0; turns < report.gamesByLength.size(); turns++) {
+        squares += (double)turns * turns * report.gamesByLength[turns];
+    }
+    double mean = report.meanLength(), stderror = sqrt((squares / report.games - mean * mean) / report.games);
+    cout << "markov classic board: one player " << exact.expectedTurns(0) << " turns expected; " << seats
+         << " players: exact game length " << exactLength << ", seat 1 wins " << winBySeat[0] << ", seat 4 " << winBySeat[3]
+         << " in " << exactSeconds * 1e3 << " ms; simulation of " << games << " games " << mean << " +- " << stderror
+         << ", seat 1 " << (double)report.winsBySeat[0] / report.games << ", seat 4 " << (double)report.winsBySeat[3] / report.games
+         << " in " << report.seconds * 1e3 << " ms" << endl;
+
+    for (int last : {1000, 2500, 5000, 10000}) {
+        mt19937 gen(last);
+        vector<Jump> ladders, snakes;
+        randomJumps(last, last / 20, gen, ladders, snakes);
+        MarkovAnalysis analysis(last, ladders, snakes, 1);
+        begin = chrono::steady_clock::now();
+        analysis.solveExpected();
+        double solveSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        begin = chrono::steady_clock::now();
+        analysis.solveDistribution(0, 1e-9);
+        double distributionSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        double mean = 0;
+        auto &odds = analysis.turnDistribution();
+        for (size_t turn = 0; turn < odds.size(); turn++) {
+            mean += turn * odds[turn];
+        }
+        cout << "markov " << last << " squares: expected " << analysis.expectedTurns(0) << " turns (solve "
+             << solveSeconds << " s), distribution over " << odds.size() - 1 << " turns with mean " << mean
+             << ", " << analysis.stuckMass() << " never finish (" << distributionSeconds << " s)" << endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkMarkov();
+        benchmarkMonteCarlo();
+        benchmarkDice();
+        benchmarkTurnLoop();
+        return 0;
+    }
+    queue<Player> seats;
+    map<int, int> start;
+    seats.push(Player("Alice", 1));
+    seats.push(Player("Bob", 2));
+    seats.push(Player("Carol", 3));
+    for (int id = 1; id <= 3; id++) {
+        start[id] = 0;
+    }
+    Board board(Dice(1), seats, classicSnakes(), classicLadders(), start);
+    board.startGame();
+    return 0;
+}
@@ -10,16 +10,6 @@ public:
     virtual ~IVendingMachine() = default;
 };
 
-class IInventory
-{
-public:
-    virtual void addProduct(int id, string name, int price, int quantity) = 0;
-    virtual bool isAvailable(int id) = 0;
-    virtual Product getProduct(int id) = 0;
-    virtual void dispenseProduct(int id) = 0;
-    virtual ~IInventory() = default;
-};
-
 class Product
 {
 public:
@@ -31,6 +21,16 @@ public:
     Product(int id, string name, int price) : id(id), name(name), price(price) {}
 };
 
+class IInventory
+{
+public:
+    virtual void addProduct(int id, string name, int price, int quantity) = 0;
+    virtual bool isAvailable(int id) = 0;
+    virtual Product getProduct(int id) = 0;
+    virtual void dispenseProduct(int id) = 0;
+    virtual ~IInventory() = default;
+};
+
 class Inventory : public IInventory
 {
 private:
@@ -72,9 +72,10 @@ private:
     State state;
     int currentBalance;
     IInventory *inventory;
+    ostream *out; // null keeps a machine quiet, as fleets run them
 
 public:
-    VendingMachine(IInventory *inv) : state(IDLE), currentBalance(0), inventory(inv) {}
+    VendingMachine(IInventory *inv, ostream *out = &cout) : state(IDLE), currentBalance(0), inventory(inv), out(out) {}
 
     void enterCash(int amount) override
     {
@@ -82,11 +83,13 @@ public:
         {
             state = ACTIVE;
             currentBalance += amount;
-            cout << "Cash entered: " << currentBalance << endl;
+            if (out)
+                *out << "Cash entered: " << currentBalance << endl;
         }
         else
         {
-            cout << "Invalid action.\n";
+            if (out)
+                *out << "Invalid action.\n";
         }
     }
 
@@ -96,14 +99,16 @@ public:
         {
             if (!inventory->isAvailable(productId))
             {
-                cout << "Product out of stock. Refunding: " << currentBalance << endl;
+                if (out)
+                    *out << "Product out of stock. Refunding: " << currentBalance << endl;
                 refund();
                 return;
             }
             Product p = inventory->getProduct(productId);
             if (currentBalance < p.price)
             {
-                cout << "Insufficient funds. Refunding: " << currentBalance << endl;
+                if (out)
+                    *out << "Insufficient funds. Refunding: " << currentBalance << endl;
                 refund();
                 return;
             }
@@ -112,7 +117,8 @@ public:
         }
         else
         {
-            cout << "Invalid action.\n";
+            if (out)
+                *out << "Invalid action.\n";
         }
     }
 
@@ -124,20 +130,466 @@ public:
 
         inventory->dispenseProduct(productId);
         currentBalance -= p.price;
-        cout << "Dispensing: " << p.name << endl;
+        if (out)
+            *out << "Dispensing: " << p.name << endl;
         state = IDLE;
     }
 
     void refund() override
     {
-        cout << "Refunding: " << currentBalance << endl;
+        if (out)
+            *out << "Refunding: " << currentBalance << endl;
         currentBalance = 0;
         state = IDLE;
     }
 };
 
-int main()
+// The products a fleet sells, shared by all of its machines so each machine
+// only stores its per-slot counts. Fill it before the fleet starts; during a
+// run it is only read, and machines only ever see it through a const pointer.
+class Catalog
+{
+public:
+    static const int MaxProducts = 8; // one per machine slot
+
+private:
+    vector<Product> products; // indexed by slot
+
+public:
+    // Returns the product's slot, replacing the entry if the id is already
+    // listed (a new price, say), or -1 once every slot is taken.
+    int add(const Product &product)
+    {
+        int existing = slotOf(product.id);
+        if (existing >= 0)
+        {
+            products[existing] = product;
+            return existing;
+        }
+        if ((int)products.size() == MaxProducts)
+            return -1;
+        products.push_back(product);
+        return (int)products.size() - 1;
+    }
+
+    // Catalogs hold a handful of products, so a scan beats hashing.
+    int slotOf(int id) const
+    {
+        for (size_t slot = 0; slot < products.size(); slot++)
+        {
+            if (products[slot].id == id)
+                return (int)slot;
+        }
+        return -1;
+    }
+
+    const Product &at(int slot) const { return products[slot]; }
+    int size() const { return (int)products.size(); }
+};
+
+// Inventory of one fleet machine: a catalog pointer plus a 16-bit count per
+// slot, instead of a map holding its own copy of every product.
+class SlotInventory : public IInventory
+{
+public:
+    static const int Slots = Catalog::MaxProducts;
+
+private:
+    const Catalog *catalog;
+    array<uint16_t, Slots> count;
+
+public:
+    SlotInventory(const Catalog *catalog) : catalog(catalog) { count.fill(0); }
+
+    // Stocks a product the catalog already lists. The catalog is shared by
+    // the whole fleet and read by every worker, so a machine cannot add
+    // products or change a price; such requests are ignored.
+    void addProduct(int id, string name, int price, int quantity) override
+    {
+        int slot = catalog->slotOf(id);
+        if (slot < 0 || catalog->at(slot).name != name || catalog->at(slot).price != price)
+            return;
+        count[slot] = (uint16_t)min(max(quantity, 0), 65535);
+    }
+
+    bool isAvailable(int id) override
+    {
+        int slot = catalog->slotOf(id);
+        return slot >= 0 && slot < Slots && count[slot] > 0;
+    }
+
+    Product getProduct(int id) override
+    {
+        int slot = catalog->slotOf(id);
+        return slot >= 0 && slot < Slots ? catalog->at(slot) : Product();
+    }
+
+    void dispenseProduct(int id) override
+    {
+        int slot = catalog->slotOf(id);
+        if (slot >= 0 && slot < Slots && count[slot] > 0)
+            count[slot]--;
+    }
+
+    // A service visit: tops every stocked slot up to `quantity`.
+    void refill(int quantity)
+    {
+        for (int slot = 0; slot < min(catalog->size(), Slots); slot++)
+            count[slot] = (uint16_t)max<int>(count[slot], min(quantity, 65535));
+    }
+
+    long long unitsLeft() const
+    {
+        long long units = 0;
+        for (uint16_t c : count)
+            units += c;
+        return units;
+    }
+};
+
+enum EventKind : uint8_t
+{
+    CASH,
+    SELECT,
+    REFUND,
+    REFILL
+};
+
+// One customer or service action at one machine. `value` is the amount for
+// CASH, the product id for SELECT and the fill level for REFILL.
+struct CustomerEvent
+{
+    uint32_t machine;
+    EventKind kind;
+    int32_t value;
+};
+
+// A fixed set of workers, each with its own task deque. Owners take from the
+// back of their deque; idle workers steal from the front of someone else's.
+// The thread calling run() works as worker 0, so a pool of one is just a loop.
+class WorkStealingPool
+{
+private:
+    struct Worker
+    {
+        mutex lock;
+        deque<int> tasks;
+    };
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> helpers;
+    mutex lock;
+    condition_variable wake, done;
+    uint64_t generation;
+    int active; // helpers inside work() for the current run
+    bool stopping;
+    const function<void(int)> *body;
+    atomic<int> remaining;
+    atomic<long long> steals;
+
+    bool pop(int self, int &task)
+    {
+        Worker &w = *workers[self];
+        lock_guard<mutex> guard(w.lock);
+        if (w.tasks.empty())
+            return false;
+        task = w.tasks.back();
+        w.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int self, int &task)
+    {
+        int n = (int)workers.size();
+        for (int i = 1; i < n; i++)
+        {
+            Worker &victim = *workers[(self + i) % n];
+            lock_guard<mutex> guard(victim.lock);
+            if (victim.tasks.empty())
+                continue;
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            steals.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void work(int self)
+    {
+        while (remaining.load(memory_order_acquire) > 0)
+        {
+            int task;
+            if (!pop(self, task) && !steal(self, task))
+            {
+                this_thread::yield(); // the last tasks are running elsewhere
+                continue;
+            }
+            (*body)(task);
+            remaining.fetch_sub(1, memory_order_acq_rel);
+        }
+    }
+
+    void helperLoop(int self)
+    {
+        uint64_t seen = 0;
+        unique_lock<mutex> guard(lock);
+        while (true)
+        {
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            active++;
+            guard.unlock();
+            work(self);
+            guard.lock();
+            if (--active == 0)
+                done.notify_all();
+        }
+    }
+
+public:
+    WorkStealingPool(int threads) : generation(0), active(0), stopping(false), body(nullptr), remaining(0), steals(0)
+    {
+        threads = max(threads, 1);
+        for (int i = 0; i < threads; i++)
+            workers.push_back(make_unique<Worker>());
+        for (int i = 1; i < threads; i++)
+            helpers.emplace_back(&WorkStealingPool::helperLoop, this, i);
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    ~WorkStealingPool()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread &t : helpers)
+            t.join();
+    }
+
+    // Runs task(0) .. task(taskCount - 1) across the pool and returns when all
+    // have finished. Tasks are dealt round-robin; stealing evens out the rest.
+    void run(int taskCount, const function<void(int)> &task)
+    {
+        if (taskCount <= 0)
+            return;
+        body = &task; // published to helpers through the deque locks below
+        remaining.store(taskCount, memory_order_relaxed);
+        for (int i = 0; i < taskCount; i++)
+        {
+            Worker &w = *workers[i % workers.size()];
+            lock_guard<mutex> guard(w.lock);
+            w.tasks.push_back(i);
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            generation++;
+        }
+        wake.notify_all();
+        work(0);
+        unique_lock<mutex> guard(lock);
+        done.wait(guard, [&] { return active == 0; });
+    }
+
+    int threads() const { return (int)workers.size(); }
+    long long stolen() const { return steals.load(memory_order_relaxed); }
+};
+
+// Hosts many VendingMachine state machines in one process. There are no
+// per-machine threads: deliver() groups a batch of events by machine block and
+// hands each block to the pool as one task, so a machine is only ever touched
+// by one worker at a time and sees its events in arrival order. The grouping
+// is a counting sort run on the pool too: each chunk of the batch counts its
+// events per block, a short serial prefix sum over the (chunk, block) table
+// gives every chunk its own write position in each block, and the chunks then
+// scatter independently.
+class VendingFleet
 {
+public:
+    static const int MachinesPerTask = 1024;
+    static const int EventsPerChunk = 1 << 16;
+
+private:
+    Catalog catalog;
+    vector<SlotInventory> inventories;
+    vector<VendingMachine> machines;
+    vector<uint32_t> blockStart;
+    vector<uint32_t> chunkOffset; // [chunk * blocks + block]: counts, then write positions
+    vector<CustomerEvent> byBlock;
+
+    void apply(const CustomerEvent &event)
+    {
+        VendingMachine &machine = machines[event.machine];
+        switch (event.kind)
+        {
+        case CASH:
+            machine.enterCash(event.value);
+            break;
+        case SELECT:
+            machine.chooseProduct(event.value);
+            break;
+        case REFUND:
+            machine.refund();
+            break;
+        case REFILL:
+            inventories[event.machine].refill(event.value);
+            break;
+        }
+    }
+
+public:
+    VendingFleet(int machineCount, const Catalog &products, int stockPerSlot) : catalog(products)
+    {
+        inventories.reserve(machineCount);
+        machines.reserve(machineCount);
+        for (int i = 0; i < machineCount; i++)
+        {
+            inventories.emplace_back(&catalog);
+            inventories.back().refill(stockPerSlot);
+            machines.emplace_back(&inventories.back(), nullptr);
+        }
+    }
+
+    VendingFleet(const VendingFleet &) = delete;
+    VendingFleet &operator=(const VendingFleet &) = delete;
+
+    // Events naming a machine outside the fleet are dropped.
+    void deliver(const vector<CustomerEvent> &events, WorkStealingPool &pool)
+    {
+        int blocks = ((int)machines.size() + MachinesPerTask - 1) / MachinesPerTask;
+        int chunks = (int)((events.size() + EventsPerChunk - 1) / EventsPerChunk);
+        auto chunkEvents = [&](int c, auto &&visit) {
+            size_t end = min(events.size(), (size_t)(c + 1) * EventsPerChunk);
+            for (size_t i = (size_t)c * EventsPerChunk; i < end; i++)
+            {
+                if (events[i].machine < machines.size())
+                    visit(events[i]);
+            }
+        };
+        chunkOffset.assign((size_t)chunks * blocks, 0);
+        pool.run(chunks, [&](int c) {
+            uint32_t *counts = &chunkOffset[(size_t)c * blocks];
+            chunkEvents(c, [&](const CustomerEvent &e) { counts[e.machine / MachinesPerTask]++; });
+        });
+        // Block-major prefix sum: block b's events from chunk 0, then chunk 1, ...
+        blockStart.assign(blocks + 1, 0);
+        uint32_t total = 0;
+        for (int b = 0; b < blocks; b++)
+        {
+            blockStart[b] = total;
+            for (int c = 0; c < chunks; c++)
+            {
+                uint32_t count = chunkOffset[(size_t)c * blocks + b];
+                chunkOffset[(size_t)c * blocks + b] = total;
+                total += count;
+            }
+        }
+        blockStart[blocks] = total;
+        byBlock.resize(total);
+        pool.run(chunks, [&](int c) {
+            uint32_t *next = &chunkOffset[(size_t)c * blocks];
+            chunkEvents(c, [&](const CustomerEvent &e) { byBlock[next[e.machine / MachinesPerTask]++] = e; });
+        });
+        pool.run(blocks, [&](int b) {
+            for (uint32_t i = blockStart[b]; i < blockStart[b + 1]; i++)
+                apply(byBlock[i]);
+        });
+    }
+
+    int size() const { return (int)machines.size(); }
+
+    long long unitsLeft() const
+    {
+        long long units = 0;
+        for (const SlotInventory &inventory : inventories)
+            units += inventory.unitsLeft();
+        return units;
+    }
+
+    // Machine state only; the batch buffers are reported by bufferBytes().
+    size_t memoryBytes() const
+    {
+        return sizeof(*this) + inventories.capacity() * sizeof(SlotInventory) + machines.capacity() * sizeof(VendingMachine);
+    }
+
+    size_t bufferBytes() const
+    {
+        return (blockStart.capacity() + chunkOffset.capacity()) * sizeof(uint32_t) + byBlock.capacity() * sizeof(CustomerEvent);
+    }
+};
+
+// Random customer sessions (cash, then a selection or a refund) spread over
+// the fleet, with the odd service refill.
+vector<CustomerEvent> customerTraffic(int machines, int events, mt19937 &gen)
+{
+    static const int notes[] = {20, 50, 100};
+    vector<CustomerEvent> traffic;
+    traffic.reserve(events + 2);
+    while ((int)traffic.size() < events)
+    {
+        uint32_t machine = gen() % machines;
+        int roll = gen() % 100;
+        if (roll == 0)
+        {
+            traffic.push_back({machine, REFILL, 10});
+            continue;
+        }
+        traffic.push_back({machine, CASH, notes[gen() % 3]});
+        if (roll < 10)
+            traffic.push_back({machine, REFUND, 0});
+        else
+            traffic.push_back({machine, SELECT, 1 + (int)(gen() % 7)}); // id 7 is not stocked
+    }
+    return traffic;
+}
+
+void benchmarkFleet()
+{
+    const int machineCount = 100000, batch = 1000000, batches = 10;
+    Catalog catalog;
+    catalog.add(Product(1, "Soda", 50));
+    catalog.add(Product(2, "Chips", 30));
+    catalog.add(Product(3, "Water", 20));
+    catalog.add(Product(4, "Candy", 40));
+    catalog.add(Product(5, "Juice", 70));
+    catalog.add(Product(6, "Coffee", 90));
+    mt19937 gen(42);
+    vector<vector<CustomerEvent>> traffic;
+    for (int i = 0; i < batches; i++)
+        traffic.push_back(customerTraffic(machineCount, batch, gen));
+
+    int cores = max(1u, thread::hardware_concurrency());
+    for (int threads = 1; threads <= max(cores, 8); threads *= 2)
+    {
+        VendingFleet fleet(machineCount, catalog, 10);
+        WorkStealingPool pool(threads);
+        long long units = fleet.unitsLeft(), events = 0;
+        auto start = chrono::steady_clock::now();
+        for (const vector<CustomerEvent> &round : traffic)
+        {
+            fleet.deliver(round, pool);
+            events += round.size();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "fleet: " << machineCount << " machines, " << threads << " threads, " << events / seconds / 1e6
+             << "M events/s, " << pool.stolen() << " steals, " << units - fleet.unitsLeft() << " units sold, "
+             << (double)fleet.memoryBytes() / machineCount << " bytes/machine + " << fleet.bufferBytes() / (1 << 20)
+             << " MB batch buffers" << endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+    {
+        benchmarkFleet();
+        return 0;
+    }
     Inventory inv;
     inv.addProduct(1, "Soda", 50, 5);
     inv.addProduct(2, "Chips", 30, 5);
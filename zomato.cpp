@@ -2,119 +2,1615 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include <string_view>
+#include <cctype>
+#include <climits>
+#include <stdexcept>
 
-enum class OrderStatus { PLACED, PREPARING, OUT_FOR_DELIVERY, DELIVERED };
+enum class OrderStatus { PLACED, PREPARING, OUT_FOR_DELIVERY, DELIVERED, CANCELLED };
 
+// Shared by every pipeline worker, so lines are written whole under a lock.
+// Benchmarks set it to nullptr to keep output off the hot path.
+std::ostream* activityLog = &std::cout;
+std::mutex activityLogMutex;
+
+void logActivity(const std::string& line) {
+    if (!activityLog) return;
+    std::lock_guard<std::mutex> lock(activityLogMutex);
+    *activityLog << line << std::endl;
+}
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Planar city coordinates in km.
+struct Location {
+    double x = 0;
+    double y = 0;
+
+    double distanceTo(const Location& other) const { return std::hypot(x - other.x, y - other.y); }
+};
+
+std::string statusName(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::PLACED: return "PLACED";
+        case OrderStatus::PREPARING: return "PREPARING";
+        case OrderStatus::OUT_FOR_DELIVERY: return "OUT_FOR_DELIVERY";
+        case OrderStatus::DELIVERED: return "DELIVERED";
+        case OrderStatus::CANCELLED: return "CANCELLED";
+    }
+    return "UNKNOWN";
+}
+
+struct OrderEvent {
+    int orderId;
+    OrderStatus status;
+    int64_t atNs;
+};
+
+// Order status changes, written once into a shared ring and read by every
+// subscriber through its own cursor, so fan-out costs one write per event no
+// matter how many consumers there are. Any thread may publish. Each slot
+// carries a sequence number that is odd while it is being written; a reader
+// re-checks it after copying, like a seqlock. The ring never waits for slow
+// subscribers: one that falls a full ring behind skips ahead and is told how
+// many events it lost.
+class OrderEventStream {
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> orderAndStatus{0};
+        std::atomic<int64_t> atNs{0};
+    };
+    std::vector<Slot> slots;
+    uint64_t mask;
+    alignas(64) std::atomic<uint64_t> head{0};
+
+public:
+    // A subscriber's position in the stream. Plain data: one per consumer,
+    // used from one thread at a time.
+    struct Subscription {
+        uint64_t cursor = 0;
+        int orderId = 0;  // 0 follows every order
+        uint64_t missed = 0;
+    };
+
+    explicit OrderEventStream(size_t capacity = 1 << 16) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots = std::vector<Slot>(size);
+        mask = size - 1;
+    }
+
+    void publish(int orderId, OrderStatus status) {
+        uint64_t position = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots[position & mask];
+        slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.orderAndStatus.store((uint64_t)(uint32_t)orderId << 8 | (uint64_t)status, std::memory_order_relaxed);
+        slot.atNs.store(nowNanos(), std::memory_order_relaxed);
+        slot.sequence.store(2 * position + 2, std::memory_order_release);
+    }
+
+    // Starts at the current end of the stream.
+    Subscription subscribe(int orderId = 0) const {
+        Subscription subscription;
+        subscription.cursor = head.load(std::memory_order_acquire);
+        subscription.orderId = orderId;
+        return subscription;
+    }
+
+    // Hands the subscriber's next events to `deliver`, in publish order, up to
+    // `limit` of them; stops early at an event still being written. Returns
+    // how many were delivered.
+    template <typename Deliver>
+    size_t poll(Subscription& subscription, Deliver&& deliver, size_t limit = SIZE_MAX) const {
+        size_t delivered = 0;
+        while (delivered < limit) {
+            const Slot& slot = slots[subscription.cursor & mask];
+            uint64_t expected = 2 * subscription.cursor + 2;
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence < expected) break;
+            if (sequence == expected) {
+                uint64_t packed = slot.orderAndStatus.load(std::memory_order_relaxed);
+                OrderEvent event{(int)(packed >> 8), (OrderStatus)(packed & 0xff), slot.atNs.load(std::memory_order_relaxed)};
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == expected) {
+                    subscription.cursor++;
+                    if (subscription.orderId == 0 || subscription.orderId == event.orderId) {
+                        deliver(event);
+                        delivered++;
+                    }
+                    continue;
+                }
+            }
+            // Lapped: the slot already holds a later event.
+            uint64_t oldest = head.load(std::memory_order_acquire) - mask;
+            if (oldest > subscription.cursor) {
+                subscription.missed += oldest - subscription.cursor;
+                subscription.cursor = oldest;
+            }
+        }
+        return delivered;
+    }
+
+    uint64_t published() const { return head.load(std::memory_order_acquire); }
+};
+
+class Restaurant;
+class DeliveryPartner;
+
+// Orders live in the OrderStore and are handed between stages by id, so every
+// stage sees the same object. Status only moves forward, under a per-order
+// lock, so a stage and a cancellation racing on another thread cannot both
+// win and subscribers see the winner's events in transition order.
 class Order {
 public:
-    static int orderCounter;
     int orderId;
     std::string user;
     std::string restaurant;
     std::vector<std::string> items;
-    OrderStatus status;
+    std::atomic<OrderStatus> status;
+    Restaurant* kitchen = nullptr;
+    DeliveryPartner* courier = nullptr;
+    OrderEventStream* events = nullptr;
+    Location deliverTo;
+    int64_t placedAtNs = 0;
+    int64_t deliveredAtNs = 0;
 
-    Order(std::string u, std::string r, std::vector<std::string> i)
-        : user(u), restaurant(r), items(i), status(OrderStatus::PLACED) {
-        orderId = ++orderCounter;
+private:
+    // Held across a status change and its event, so each order's events
+    // reach the stream in the order its status changed. Only ever held for
+    // a CAS and a publish, hence a one-byte spin lock rather than a mutex.
+    std::atomic_flag transitioning = ATOMIC_FLAG_INIT;
+    class TransitionLock {
+        std::atomic_flag* flag;
+    public:
+        explicit TransitionLock(Order& order) : flag(&order.transitioning) {
+            while (flag->test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+        }
+        ~TransitionLock() { release(); }
+        void release() {
+            if (flag) flag->clear(std::memory_order_release);
+            flag = nullptr;
+        }
+    };
+
+public:
+    Order(int id, std::string u, Restaurant* k, std::string r, std::vector<std::string> i, Location to = {})
+        : orderId(id), user(u), restaurant(r), items(i), status(OrderStatus::PLACED), kitchen(k), deliverTo(to) {}
+    Order(const Order&) = delete;
+    Order& operator=(const Order&) = delete;
+
+    // Moves from `from` to `to`; false if the order was no longer in `from`.
+    bool advance(OrderStatus from, OrderStatus to) {
+        TransitionLock lock(*this);
+        if (!status.compare_exchange_strong(from, to, std::memory_order_acq_rel)) return false;
+        if (events) events->publish(orderId, to);
+        lock.release();
+        if (activityLog) logActivity("Order " + std::to_string(orderId) + " status updated to: " + statusName(to));
+        return true;
     }
 
-    void updateStatus(OrderStatus newStatus) {
-        status = newStatus;
-        std::cout << "Order " << orderId << " status updated to: " << getStatusString() << std::endl;
+    // Possible until a partner picks the order up.
+    bool cancel() {
+        TransitionLock lock(*this);
+        OrderStatus current = status.load(std::memory_order_acquire);
+        if (current != OrderStatus::PLACED && current != OrderStatus::PREPARING) return false;
+        status.store(OrderStatus::CANCELLED, std::memory_order_release);
+        if (events) events->publish(orderId, OrderStatus::CANCELLED);
+        lock.release();
+        if (activityLog) logActivity("Order " + std::to_string(orderId) + " status updated to: CANCELLED");
+        return true;
     }
 
-    std::string getStatusString() {
-        switch (status) {
-            case OrderStatus::PLACED: return "PLACED";
-            case OrderStatus::PREPARING: return "PREPARING";
-            case OrderStatus::OUT_FOR_DELIVERY: return "OUT_FOR_DELIVERY";
-            case OrderStatus::DELIVERED: return "DELIVERED";
+    std::string getStatusString() { return statusName(status.load(std::memory_order_acquire)); }
+};
+// Owns every order. Ids come from an atomic counter and index lazily
+// allocated chunks, so creation and lookup by id are lock-free from any
+// thread; a chunk is published by CAS and the loser of a race frees its copy.
+// Chunks hang off lazily allocated directory pages, so the store grows to
+// the whole positive int id range (about 2.1 billion orders) while an idle
+// store costs one 4 KB page table. Orders are kept for the life of the store,
+// since lookups hand out plain pointers; memory, not ids, is the practical
+// limit.
+// Lookups by user and restaurant go through sharded secondary indexes, each
+// shard behind its own mutex. With an event stream attached, every order's
+// status changes (starting with PLACED) are published to it.
+class OrderStore {
+private:
+    static const int ChunkBits = 12;
+    static const int ChunkSize = 1 << ChunkBits;
+    static const int PageBits = 10;  // chunks per directory page
+    static const int PageCount = 1 << (31 - ChunkBits - PageBits);
+    static const int ShardCount = 64;
+    struct Chunk {
+        std::atomic<Order*> slots[ChunkSize];
+    };
+    struct Page {
+        std::atomic<Chunk*> chunks[1 << PageBits] = {};
+    };
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::vector<int>> ids;
+    };
+    std::atomic<Page*> pages[PageCount] = {};
+    std::atomic<int64_t> lastOrderId{0};
+    OrderEventStream* events;
+    Shard byUser[ShardCount];
+    Shard byRestaurant[ShardCount];
+
+    static void addTo(Shard* shards, const std::string& key, int orderId) {
+        Shard& shard = shards[std::hash<std::string>()(key) % ShardCount];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.ids[key].push_back(orderId);
+    }
+
+    static std::vector<int> lookup(Shard* shards, const std::string& key) {
+        Shard& shard = shards[std::hash<std::string>()(key) % ShardCount];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.ids.find(key);
+        return it == shard.ids.end() ? std::vector<int>() : it->second;
+    }
+
+    // Loads `slot`, first publishing a fresh T there by CAS if it is empty.
+    template <typename T>
+    static T* getOrCreate(std::atomic<T*>& slot) {
+        T* existing = slot.load(std::memory_order_acquire);
+        if (existing) return existing;
+        T* fresh = new T();
+        if (slot.compare_exchange_strong(existing, fresh, std::memory_order_acq_rel)) return fresh;
+        delete fresh;
+        return existing;
+    }
+
+    std::atomic<Order*>& slotFor(int orderId) {
+        Page* page = getOrCreate(pages[orderId >> (ChunkBits + PageBits)]);
+        Chunk* chunk = getOrCreate(page->chunks[(orderId >> ChunkBits) & ((1 << PageBits) - 1)]);
+        return chunk->slots[orderId & (ChunkSize - 1)];
+    }
+
+public:
+    explicit OrderStore(OrderEventStream* e = nullptr) : events(e) {}
+
+    ~OrderStore() {
+        for (auto& p : pages) {
+            Page* page = p.load();
+            if (!page) continue;
+            for (auto& c : page->chunks) {
+                Chunk* chunk = c.load();
+                if (!chunk) continue;
+                for (auto& slot : chunk->slots) delete slot.load();
+                delete chunk;
+            }
+            delete page;
         }
-        return "UNKNOWN";
     }
+
+    // Throws std::length_error once all INT_MAX ids have been handed out.
+    Order* create(std::string user, Restaurant* kitchen, std::string restaurant, std::vector<std::string> items,
+                  Location deliverTo = {}) {
+        int64_t nextId = lastOrderId.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (nextId > INT_MAX) throw std::length_error("OrderStore: order ids exhausted");
+        int orderId = (int)nextId;
+        Order* order = new Order(orderId, std::move(user), kitchen, std::move(restaurant), std::move(items), deliverTo);
+        order->events = events;
+        // PLACED goes out before the order is reachable, so no transition
+        // another thread makes can be published ahead of it.
+        if (events) events->publish(orderId, OrderStatus::PLACED);
+        slotFor(orderId).store(order, std::memory_order_release);
+        addTo(byUser, order->user, orderId);
+        addTo(byRestaurant, order->restaurant, orderId);
+        return order;
+    }
+
+    Order* get(int orderId) const {
+        if (orderId <= 0) return nullptr;
+        Page* page = pages[orderId >> (ChunkBits + PageBits)].load(std::memory_order_acquire);
+        if (!page) return nullptr;
+        Chunk* chunk = page->chunks[(orderId >> ChunkBits) & ((1 << PageBits) - 1)].load(std::memory_order_acquire);
+        return chunk ? chunk->slots[orderId & (ChunkSize - 1)].load(std::memory_order_acquire) : nullptr;
+    }
+
+    std::vector<int> ordersOfUser(const std::string& user) { return lookup(byUser, user); }
+
+    std::vector<int> ordersAtRestaurant(const std::string& restaurant) { return lookup(byRestaurant, restaurant); }
+
+    int size() const { return (int)std::min<int64_t>(lastOrderId.load(std::memory_order_relaxed), INT_MAX); }
 };
-int Order::orderCounter = 0;
 
 class Restaurant {
 public:
     std::string name;
     std::vector<std::string> menu;
-    std::vector<Order> orders;
+    Location location;
+    int searchId = -1;
+    std::vector<int> orders;
+    std::mutex ordersMutex;
 
-    Restaurant(std::string n, std::vector<std::string> m) : name(n), menu(m) {}
+    Restaurant(std::string n, std::vector<std::string> m, Location at = {}) : name(n), menu(m), location(at) {}
 
-    void acceptOrder(Order& order) {
-        std::cout << "Restaurant " << name << " is preparing Order " << order.orderId << std::endl;
-        order.updateStatus(OrderStatus::PREPARING);
-        orders.push_back(order);
+    // False if the order was cancelled before the kitchen got to it.
+    bool acceptOrder(Order& order) {
+        if (!order.advance(OrderStatus::PLACED, OrderStatus::PREPARING)) return false;
+        if (activityLog) logActivity("Restaurant " + name + " is preparing Order " + std::to_string(order.orderId));
+        std::lock_guard<std::mutex> lock(ordersMutex);
+        orders.push_back(order.orderId);
+        return true;
     }
 };
 
 class DeliveryPartner {
 public:
     std::string name;
+    int dispatchId = -1;  // slot in the DeliveryDispatcher, if registered
 
     DeliveryPartner(std::string n) : name(n) {}
 
-    void deliverOrder(Order& order) {
-        std::cout << "Delivery Partner " << name << " picked up Order " << order.orderId << std::endl;
-        order.updateStatus(OrderStatus::OUT_FOR_DELIVERY);
-        order.updateStatus(OrderStatus::DELIVERED);
+    // False if the order was cancelled while waiting for a partner.
+    bool pickUp(Order& order) {
+        order.courier = this;
+        if (!order.advance(OrderStatus::PREPARING, OrderStatus::OUT_FOR_DELIVERY)) return false;
+        if (activityLog) logActivity("Delivery Partner " + name + " picked up Order " + std::to_string(order.orderId));
+        return true;
+    }
+
+    bool dropOff(Order& order) {
+        order.deliveredAtNs = nowNanos();
+        return order.advance(OrderStatus::OUT_FOR_DELIVERY, OrderStatus::DELIVERED);
     }
 };
 
-class User {
+// Vyukov's bounded MPMC queue: a ring of cells, each with a sequence number
+// telling producers and consumers whose turn the cell is. Lock-free for any
+// number of both.
+template <typename T>
+class BoundedMpmcQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    std::vector<Cell> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<size_t> head{0};
+
 public:
-    std::string name;
+    explicit BoundedMpmcQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells = std::vector<Cell>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
 
-    User(std::string n) : name(n) {}
+    bool tryPush(const T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            intptr_t diff = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
-    Order placeOrder(Restaurant& restaurant, std::vector<std::string> items) {
-        std::cout << name << " placed an order at " << restaurant.name << std::endl;
-        Order order(name, restaurant.name, items);
-        restaurant.acceptOrder(order);
-        return order;
+    bool tryPop(T& out) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            intptr_t diff = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = cell.value;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Spins briefly, then yields, then naps, so idle workers stay cheap without
+// adding much latency when work arrives.
+class Backoff {
+private:
+    int misses = 0;
+
+public:
+    void reset() { misses = 0; }
+    void pause() {
+        if (++misses < 16) return;
+        if (misses < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+};
+
+// Uniform grid over the city holding the partners that are idle right now.
+// Each cell is an unordered bucket of partner ids; a partner remembers its
+// cell and slot so removal is a swap with the bucket's last entry.
+class PartnerGrid {
+private:
+    Location origin;
+    double cellKm;
+    int cols, rows;
+    std::vector<std::vector<int>> cells;
+    std::vector<int> cellOf, slotOf;
+    std::vector<Location> positions;
+
+    int clampCol(double x) const { return std::min(cols - 1, std::max(0, (int)std::floor((x - origin.x) / cellKm))); }
+    int clampRow(double y) const { return std::min(rows - 1, std::max(0, (int)std::floor((y - origin.y) / cellKm))); }
+
+public:
+    PartnerGrid(Location o, double widthKm, double heightKm, double cellKm)
+        : origin(o), cellKm(cellKm), cols(std::max(1, (int)std::ceil(widthKm / cellKm))),
+          rows(std::max(1, (int)std::ceil(heightKm / cellKm))), cells((size_t)cols * rows) {}
+
+    void insert(int partner, Location at) {
+        if (partner >= (int)cellOf.size()) {
+            cellOf.resize(partner + 1, -1);
+            slotOf.resize(partner + 1, -1);
+            positions.resize(partner + 1);
+        }
+        if (cellOf[partner] >= 0) erase(partner);
+        int cell = clampRow(at.y) * cols + clampCol(at.x);
+        cellOf[partner] = cell;
+        slotOf[partner] = (int)cells[cell].size();
+        cells[cell].push_back(partner);
+        positions[partner] = at;
+    }
+
+    void erase(int partner) {
+        if (partner < 0 || partner >= (int)cellOf.size() || cellOf[partner] < 0) return;
+        auto& cell = cells[cellOf[partner]];
+        int moved = cell.back();
+        cell[slotOf[partner]] = moved;
+        slotOf[moved] = slotOf[partner];
+        cell.pop_back();
+        cellOf[partner] = slotOf[partner] = -1;
+    }
+
+    // Moves an indexed partner; touches the buckets only when it changes cell.
+    void move(int partner, Location at) {
+        if (partner < 0 || partner >= (int)cellOf.size() || cellOf[partner] < 0) return;
+        positions[partner] = at;
+        if (clampRow(at.y) * cols + clampCol(at.x) != cellOf[partner]) insert(partner, at);
+    }
+
+    bool contains(int partner) const { return partner >= 0 && partner < (int)cellOf.size() && cellOf[partner] >= 0; }
+
+    // Last position seen, kept after the partner is erased.
+    Location positionOf(int partner) const { return positions[partner]; }
+
+    // Up to k indexed partners within maxKm of `at`, nearest first, appended
+    // to `out` as (distance, partner). Scans rings of cells outward and stops
+    // once no unscanned cell can beat the k-th best.
+    void nearest(Location at, int k, double maxKm, std::vector<std::pair<double, int>>& out) const {
+        std::vector<std::pair<double, int>> best;  // max-heap on distance
+        int cx = clampCol(at.x), cy = clampRow(at.y);
+        double inset = std::min({at.x - (origin.x + cx * cellKm), origin.x + (cx + 1) * cellKm - at.x,
+                                 at.y - (origin.y + cy * cellKm), origin.y + (cy + 1) * cellKm - at.y});
+        inset = std::max(0.0, inset);
+        int maxRing = std::min(std::max({cx, cols - 1 - cx, cy, rows - 1 - cy}), (int)std::ceil(maxKm / cellKm) + 1);
+        for (int r = 0; r <= maxRing; r++) {
+            double ringFloor = inset + (r - 1) * cellKm;
+            if (ringFloor > maxKm || ((int)best.size() == k && best.front().first <= ringFloor)) break;
+            for (int row = std::max(0, cy - r); row <= std::min(rows - 1, cy + r); row++) {
+                bool edgeRow = row == cy - r || row == cy + r;
+                int step = edgeRow ? 1 : std::max(1, 2 * r);
+                for (int col = cx - r; col <= cx + r; col += step) {
+                    if (col < 0 || col >= cols) continue;
+                    for (int partner : cells[row * cols + col]) {
+                        double d = positions[partner].distanceTo(at);
+                        if (d > maxKm || ((int)best.size() == k && d >= best.front().first)) continue;
+                        best.emplace_back(d, partner);
+                        std::push_heap(best.begin(), best.end());
+                        if ((int)best.size() > k) {
+                            std::pop_heap(best.begin(), best.end());
+                            best.pop_back();
+                        }
+                    }
+                }
+            }
+        }
+        std::sort_heap(best.begin(), best.end());
+        out.insert(out.end(), best.begin(), best.end());
+    }
+};
+
+// Matches orders that are ready for pickup to idle partners near the
+// restaurant. The grid belongs to the thread calling matchBatch; other
+// threads report positions and freed partners through a queue that is applied
+// at the start of each batch.
+//
+// BATCHED takes each order's few nearest candidates, sorts all (order,
+// partner) pairs by distance and assigns greedily, so an order does not grab
+// a partner that a later order in the batch needed more. FIRST_COME gives
+// each order its nearest idle partner in arrival order.
+class DeliveryDispatcher {
+public:
+    enum Strategy { BATCHED, FIRST_COME };
+
+private:
+    struct PartnerUpdate {
+        int partner;
+        Location at;
+        bool freed;
+    };
+    std::vector<DeliveryPartner*> partners;
+    PartnerGrid idle;
+    BoundedMpmcQueue<PartnerUpdate> updates;
+    double maxPickupKm;
+    Strategy strategy;
+    int candidatesPerOrder = 4;
+    std::vector<std::pair<double, int>> candidates;
+    std::vector<std::pair<double, std::pair<int, int>>> edges;
+
+    void applyUpdates() {
+        PartnerUpdate update;
+        while (updates.tryPop(update)) {
+            if (update.freed) idle.insert(update.partner, update.at);
+            else idle.move(update.partner, update.at);
+        }
+    }
+
+public:
+    std::chrono::milliseconds interval;
+
+    DeliveryDispatcher(Location origin, double widthKm, double heightKm, double cellKm = 0.5, double maxPickupKm = 5,
+                       Strategy strategy = BATCHED, std::chrono::milliseconds interval = std::chrono::milliseconds(200))
+        : idle(origin, widthKm, heightKm, cellKm), updates(1 << 18), maxPickupKm(maxPickupKm), strategy(strategy),
+          interval(interval) {}
+
+    // Registers an idle partner. Call before matching starts.
+    int addPartner(DeliveryPartner* partner, Location at) {
+        partner->dispatchId = (int)partners.size();
+        partners.push_back(partner);
+        idle.insert(partner->dispatchId, at);
+        return partner->dispatchId;
+    }
+
+    size_t partnerCount() const { return partners.size(); }
+
+    // Any thread. Position pings are lossy: dropped if the queue is full.
+    void reportPosition(int partner, Location at) { updates.tryPush({partner, at, false}); }
+
+    // Any thread. The partner becomes matchable again at `at`.
+    void release(int partner, Location at) {
+        Backoff backoff;
+        while (!updates.tryPush({partner, at, true})) backoff.pause();
+    }
+
+    // Matching thread only. Returns a partner whose assignment fell through
+    // (the order was cancelled) to the pool where it was matched.
+    void putBack(int partner) { idle.insert(partner, idle.positionOf(partner)); }
+
+    // Assigns as many `pending` orders as it can, appends the pairs to
+    // `assigned` and leaves the unmatched orders in `pending` for next time.
+    void matchBatch(std::vector<Order*>& pending, std::vector<std::pair<Order*, DeliveryPartner*>>& assigned) {
+        applyUpdates();
+        std::vector<int> partnerFor(pending.size(), -1);
+        if (strategy == BATCHED) {
+            edges.clear();
+            for (size_t i = 0; i < pending.size(); i++) {
+                candidates.clear();
+                idle.nearest(pending[i]->kitchen->location, candidatesPerOrder, maxPickupKm, candidates);
+                for (auto& c : candidates) edges.push_back({c.first, {(int)i, c.second}});
+            }
+            std::sort(edges.begin(), edges.end());
+            for (auto& edge : edges) {
+                int order = edge.second.first, partner = edge.second.second;
+                if (partnerFor[order] >= 0 || !idle.contains(partner)) continue;
+                partnerFor[order] = partner;
+                idle.erase(partner);
+            }
+        }
+        // FIRST_COME, and a second chance for orders whose candidates were all taken.
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (partnerFor[i] >= 0) continue;
+            candidates.clear();
+            idle.nearest(pending[i]->kitchen->location, 1, maxPickupKm, candidates);
+            if (candidates.empty()) continue;
+            partnerFor[i] = candidates[0].second;
+            idle.erase(partnerFor[i]);
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (partnerFor[i] >= 0) assigned.push_back({pending[i], partners[partnerFor[i]]});
+            else pending[kept++] = pending[i];
+        }
+        pending.resize(kept);
+    }
+};
+
+// placed -> preparing -> out for delivery -> delivered. Each arrow is a
+// lock-free queue of order ids drained by that stage's own worker pool. With
+// a DeliveryDispatcher attached, the dispatch stage is instead a single thread
+// that matches whatever is ready once per dispatcher interval. An order whose
+// transition fails (it was cancelled) leaves the pipeline at that stage; one
+// that cannot be handled yet (no partner) is held by the worker and retried
+// whenever its queue runs dry. An order still without a partner after the
+// pickup timeout, or when the pipeline is stopping, is cancelled.
+class OrderPipeline {
+private:
+    enum Outcome { FORWARD, FINISHED, RETRY };
+    struct Stage {
+        BoundedMpmcQueue<int> queue;
+        std::function<Outcome(Order&)> handle;
+        Stage* next = nullptr;
+        std::vector<std::thread> workers;
+        Stage(size_t capacity) : queue(capacity) {}
+    };
+    OrderStore& store;
+    std::vector<DeliveryPartner*> partners;
+    std::atomic<size_t> nextPartner{0};
+    DeliveryDispatcher* dispatcher = nullptr;
+    Stage kitchen, dispatch, delivery;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::chrono::nanoseconds pickupTimeout = std::chrono::minutes(30);
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> finished{0};
+
+    void push(Stage& stage, int orderId) {
+        Backoff backoff;
+        while (!stage.queue.tryPush(orderId)) backoff.pause();
+    }
+
+    // Whether an order waiting for a partner should stop waiting.
+    bool overdue(const Order& order) const {
+        return stopping.load(std::memory_order_acquire) || nowNanos() - order.placedAtNs > pickupTimeout.count();
+    }
+
+    void process(Stage& stage, int orderId, std::vector<int>& waiting) {
+        Outcome outcome = stage.handle(*store.get(orderId));
+        if (outcome == RETRY) waiting.push_back(orderId);
+        else if (outcome == FORWARD && stage.next) push(*stage.next, orderId);
+        else finished.fetch_add(1, std::memory_order_release);
+    }
+
+    // Retried orders stay with the worker rather than going back on the
+    // queue, which producers may have filled in the meantime.
+    void work(Stage& stage) {
+        Backoff backoff;
+        std::vector<int> waiting, retrying;
+        int orderId;
+        while (true) {
+            if (stage.queue.tryPop(orderId)) {
+                backoff.reset();
+                process(stage, orderId, waiting);
+            } else if (!waiting.empty()) {
+                retrying.swap(waiting);
+                for (int id : retrying) process(stage, id, waiting);
+                retrying.clear();
+                backoff.pause();
+            } else if (!running.load(std::memory_order_acquire)) {
+                return;
+            } else {
+                backoff.pause();
+            }
+        }
+    }
+
+    void dispatchInBatches() {
+        std::vector<Order*> pending;
+        std::vector<std::pair<Order*, DeliveryPartner*>> assigned;
+        while (running.load(std::memory_order_acquire)) {
+            auto due = std::chrono::steady_clock::now() + dispatcher->interval;
+            int orderId;
+            while (dispatch.queue.tryPop(orderId)) pending.push_back(store.get(orderId));
+            assigned.clear();
+            dispatcher->matchBatch(pending, assigned);
+            for (auto& match : assigned) {
+                if (match.second->pickUp(*match.first)) {
+                    push(delivery, match.first->orderId);
+                } else {
+                    dispatcher->putBack(match.second->dispatchId);
+                    finished.fetch_add(1, std::memory_order_release);
+                }
+            }
+            // Cancelled orders and those with no partner in reach leave here.
+            size_t kept = 0;
+            for (Order* order : pending) {
+                if (order->status.load(std::memory_order_acquire) == OrderStatus::CANCELLED || overdue(*order)) {
+                    order->cancel();
+                    finished.fetch_add(1, std::memory_order_release);
+                } else {
+                    pending[kept++] = order;
+                }
+            }
+            pending.resize(kept);
+            std::this_thread::sleep_until(due);
+        }
+    }
+
+public:
+    OrderPipeline(OrderStore& s, std::vector<DeliveryPartner*> p, size_t queueCapacity = 1 << 16)
+        : store(s), partners(p), kitchen(queueCapacity), dispatch(queueCapacity), delivery(queueCapacity) {
+        kitchen.handle = [](Order& order) { return order.kitchen->acceptOrder(order) ? FORWARD : FINISHED; };
+        kitchen.next = &dispatch;
+        dispatch.handle = [this](Order& order) {
+            if (order.status.load(std::memory_order_acquire) == OrderStatus::CANCELLED) return FINISHED;
+            if (partners.empty()) {
+                if (!overdue(order)) return RETRY;
+                order.cancel();
+                return FINISHED;
+            }
+            DeliveryPartner* partner = partners[nextPartner.fetch_add(1, std::memory_order_relaxed) % partners.size()];
+            return partner->pickUp(order) ? FORWARD : FINISHED;
+        };
+        dispatch.next = &delivery;
+        delivery.handle = [this](Order& order) {
+            bool delivered = order.courier->dropOff(order);
+            if (dispatcher) dispatcher->release(order.courier->dispatchId, order.deliverTo);
+            return delivered ? FORWARD : FINISHED;
+        };
+    }
+
+    // Call before start.
+    void dispatchWith(DeliveryDispatcher* d) { dispatcher = d; }
+
+    // Call before start. How long an order may wait for a partner, counted
+    // from when it was placed, before it is cancelled.
+    void cancelUnpickedAfter(std::chrono::milliseconds timeout) { pickupTimeout = timeout; }
+
+    ~OrderPipeline() { stop(); }
+
+    void start(int workersPerStage) {
+        if (running.exchange(true)) return;
+        stopping.store(false, std::memory_order_release);
+        for (Stage* stage : {&kitchen, &dispatch, &delivery}) {
+            if (stage == &dispatch && dispatcher) {
+                stage->workers.emplace_back([this] { dispatchInBatches(); });
+                continue;
+            }
+            for (int i = 0; i < workersPerStage; i++) stage->workers.emplace_back([this, stage] { work(*stage); });
+        }
+    }
+
+    // Gives in-flight orders up to `grace` to finish, then cancels every order
+    // still waiting for a partner and drains what is left, which no longer
+    // depends on partners turning up. Then clears the one running flag every
+    // stage polls and joins all workers. Stages are not stopped one at a
+    // time: nothing is in flight by then, so they all exit together.
+    void stop(std::chrono::milliseconds grace = std::chrono::seconds(5)) {
+        if (!running.load(std::memory_order_acquire)) return;
+        drain(grace);
+        stopping.store(true, std::memory_order_release);
+        drain();
+        running.store(false, std::memory_order_release);
+        for (Stage* stage : {&kitchen, &dispatch, &delivery}) {
+            for (auto& worker : stage->workers) worker.join();
+            stage->workers.clear();
+        }
+    }
+
+    void submit(Order& order) {
+        order.placedAtNs = nowNanos();
+        submitted.fetch_add(1, std::memory_order_relaxed);
+        push(kitchen, order.orderId);
+    }
+
+    // Waits until everything submitted so far has been delivered or
+    // cancelled, or until `timeout`; true if it all finished.
+    bool drain(std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+        auto start = std::chrono::steady_clock::now();
+        while (running.load() && finished.load(std::memory_order_acquire) < submitted.load(std::memory_order_relaxed)) {
+            auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            if (waited >= timeout) return false;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    uint64_t finishedCount() const { return finished.load(std::memory_order_acquire); }
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+};
+
+// Interns strings into one contiguous arena. Ids are dense, start at 0 and
+// never change; lookups go through an open-addressing table of ids.
+class StringPool {
+private:
+    std::string arena;
+    std::vector<uint32_t> offsets{0};
+    std::vector<uint32_t> table;  // id + 1, 0 when empty
+
+    static size_t hashOf(std::string_view s) { return std::hash<std::string_view>()(s); }
+
+    void place(uint32_t id) {
+        size_t mask = table.size() - 1;
+        size_t i = hashOf(view(id)) & mask;
+        while (table[i]) i = (i + 1) & mask;
+        table[i] = id + 1;
+    }
+
+public:
+    static const uint32_t None = UINT32_MAX;
+
+    uint32_t find(std::string_view s) const {
+        if (table.empty()) return None;
+        size_t mask = table.size() - 1;
+        for (size_t i = hashOf(s) & mask; table[i]; i = (i + 1) & mask) {
+            if (view(table[i] - 1) == s) return table[i] - 1;
+        }
+        return None;
+    }
+
+    uint32_t intern(std::string_view s) {
+        uint32_t id = find(s);
+        if (id != None) return id;
+        id = (uint32_t)size();
+        arena.append(s.data(), s.size());
+        offsets.push_back((uint32_t)arena.size());
+        if ((size() + 1) * 2 > table.size()) {
+            table.assign(std::max<size_t>(1024, table.size() * 2), 0);
+            for (uint32_t i = 0; i < size(); i++) place(i);
+        } else {
+            place(id);
+        }
+        return id;
+    }
+
+    std::string_view view(uint32_t id) const {
+        return std::string_view(arena.data() + offsets[id], offsets[id + 1] - offsets[id]);
+    }
+
+    size_t size() const { return offsets.size() - 1; }
+
+    size_t memoryBytes() const {
+        return arena.capacity() + offsets.capacity() * sizeof(uint32_t) + table.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Every distinct search token, interned once and shared by the name and dish
+// indexes. Keeps the tokens in sorted order for prefix lookups and a trigram
+// index over them for typo-tolerant lookups.
+class SearchVocabulary {
+private:
+    static const int Alphabet = 37;  // '$' padding, a-z, 0-9
+    StringPool tokens;
+    std::vector<uint32_t> sorted;
+    std::vector<std::vector<uint32_t>> trigrams;  // trigram code -> token ids
+    std::vector<uint16_t> sharedCounts;
+
+    static int code(char c) { return c == '$' ? 0 : (c >= 'a' ? 1 + (c - 'a') : 27 + (c - '0')); }
+
+    template <typename Visit>
+    static void forEachTrigram(std::string_view token, Visit&& visit) {
+        std::string padded = "$" + std::string(token) + "$";
+        for (size_t i = 0; i + 3 <= padded.size(); i++) {
+            visit((code(padded[i]) * Alphabet + code(padded[i + 1])) * Alphabet + code(padded[i + 2]));
+        }
+    }
+
+    // Optimal string alignment distance, giving up once it must exceed maxEdits.
+    static int editDistance(std::string_view a, std::string_view b, int maxEdits) {
+        const size_t MaxLength = 63;
+        if ((int)a.size() - (int)b.size() > maxEdits || (int)b.size() - (int)a.size() > maxEdits) return maxEdits + 1;
+        if (a.size() > MaxLength || b.size() > MaxLength) return maxEdits + 1;
+        int rows[3][MaxLength + 1];
+        int *prev2 = rows[0], *prev = rows[1], *cur = rows[2];
+        for (size_t j = 0; j <= b.size(); j++) prev[j] = (int)j;
+        for (size_t i = 1; i <= a.size(); i++) {
+            cur[0] = (int)i;
+            int rowMin = cur[0];
+            for (size_t j = 1; j <= b.size(); j++) {
+                cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + (a[i - 1] != b[j - 1])});
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) cur[j] = std::min(cur[j], prev2[j - 2] + 1);
+                rowMin = std::min(rowMin, cur[j]);
+            }
+            if (rowMin > maxEdits) return maxEdits + 1;
+            int* recycled = prev2;
+            prev2 = prev;
+            prev = cur;
+            cur = recycled;
+        }
+        return prev[b.size()];
+    }
+
+    void ensureSorted() {
+        if (sorted.size() == tokens.size()) return;
+        sorted.resize(tokens.size());
+        for (uint32_t i = 0; i < sorted.size(); i++) sorted[i] = i;
+        std::sort(sorted.begin(), sorted.end(), [this](uint32_t a, uint32_t b) { return tokens.view(a) < tokens.view(b); });
+    }
+
+public:
+    SearchVocabulary() : trigrams(Alphabet * Alphabet * Alphabet) {}
+
+    uint32_t add(std::string_view token) {
+        size_t before = tokens.size();
+        uint32_t id = tokens.intern(token);
+        if (tokens.size() != before) {
+            forEachTrigram(token, [&](int t) {
+                if (trigrams[t].empty() || trigrams[t].back() != id) trigrams[t].push_back(id);
+            });
+        }
+        return id;
+    }
+
+    uint32_t find(std::string_view token) const { return tokens.find(token); }
+
+    size_t size() const { return tokens.size(); }
+
+    // Tokens starting with `prefix` and passing `accept`, in sorted order, at
+    // most `limit` of them.
+    template <typename Accept>
+    void withPrefix(std::string_view prefix, size_t limit, std::vector<uint32_t>& out, Accept&& accept) {
+        ensureSorted();
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), prefix,
+                                   [this](uint32_t id, std::string_view p) { return tokens.view(id) < p; });
+        for (; it != sorted.end() && limit > 0; ++it) {
+            std::string_view token = tokens.view(*it);
+            if (token.compare(0, prefix.size(), prefix) != 0) break;
+            if (!accept(*it)) continue;
+            out.push_back(*it);
+            limit--;
+        }
+    }
+
+    // Tokens passing `accept` at the smallest edit distance (at most
+    // maxEdits) from `word`. Candidates must share enough trigrams to be
+    // within maxEdits, since one edit changes at most three of them. That
+    // misses transpositions in short words, so for those the tokens sharing
+    // the word's first letter are checked as well.
+    template <typename Accept>
+    void similarTo(std::string_view word, int maxEdits, std::vector<uint32_t>& out, Accept&& accept) {
+        if (word.empty()) return;
+        ensureSorted();
+        sharedCounts.resize(tokens.size());
+        std::vector<uint32_t> touched;
+        int wordTrigrams = 0;
+        forEachTrigram(word, [&](int t) {
+            wordTrigrams++;
+            for (uint32_t id : trigrams[t]) {
+                if (sharedCounts[id]++ == 0) touched.push_back(id);
+            }
+        });
+        int needed = std::max(1, wordTrigrams - 3 * maxEdits);
+        for (uint32_t id : touched) {
+            if (sharedCounts[id] < needed || !accept(id)) sharedCounts[id] = 0;
+        }
+        size_t before = touched.size();
+        if (word.size() <= 5) withPrefix(word.substr(0, 1), SIZE_MAX, touched, accept);
+        for (size_t i = before; i < touched.size(); i++) {
+            if (sharedCounts[touched[i]] == 0) sharedCounts[touched[i]] = 1;
+        }
+        int best = maxEdits + 1;
+        size_t firstBest = out.size();
+        for (uint32_t id : touched) {
+            if (sharedCounts[id] > 0) {
+                int d = editDistance(word, tokens.view(id), std::min(best, maxEdits));
+                if (d < best) {
+                    best = d;
+                    out.resize(firstBest);
+                }
+                if (d == best && d <= maxEdits) out.push_back(id);
+            }
+            sharedCounts[id] = 0;
+        }
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = tokens.memoryBytes() + sorted.capacity() * sizeof(uint32_t) + sharedCounts.capacity() * sizeof(uint16_t);
+        for (auto& list : trigrams) bytes += sizeof(list) + list.capacity() * sizeof(uint32_t);
+        return bytes;
+    }
+};
+
+// Inverted index from token to the documents (restaurants) containing it,
+// plus the forward lists needed to test a single document for a token.
+// Documents are added with increasing ids, so posting lists stay sorted.
+class TokenPostings {
+private:
+    std::vector<std::vector<uint32_t>> postings;
+    std::vector<uint32_t> forward;
+    std::vector<uint32_t> forwardStart{0};
+    static const std::vector<uint32_t> empty;
+
+public:
+    void add(uint32_t doc, std::vector<uint32_t> tokenIds) {
+        std::sort(tokenIds.begin(), tokenIds.end());
+        tokenIds.erase(std::unique(tokenIds.begin(), tokenIds.end()), tokenIds.end());
+        for (uint32_t token : tokenIds) {
+            if (token >= postings.size()) postings.resize(token + 1);
+            postings[token].push_back(doc);
+        }
+        forward.insert(forward.end(), tokenIds.begin(), tokenIds.end());
+        forwardStart.push_back((uint32_t)forward.size());
+    }
+
+    const std::vector<uint32_t>& docsWith(uint32_t token) const { return token < postings.size() ? postings[token] : empty; }
+
+    // `tokens` must be sorted.
+    bool docHasAny(uint32_t doc, const std::vector<uint32_t>& tokens) const {
+        for (uint32_t i = forwardStart[doc]; i < forwardStart[doc + 1]; i++) {
+            if (std::binary_search(tokens.begin(), tokens.end(), forward[i])) return true;
+        }
+        return false;
+    }
+
+    void shrinkToFit() {
+        for (auto& list : postings) list.shrink_to_fit();
+        forward.shrink_to_fit();
+        forwardStart.shrink_to_fit();
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = (forward.capacity() + forwardStart.capacity()) * sizeof(uint32_t);
+        for (auto& list : postings) bytes += sizeof(list) + list.capacity() * sizeof(uint32_t);
+        return bytes;
+    }
+};
+const std::vector<uint32_t> TokenPostings::empty;
+
+// Restaurant lookup by name and by dish. Text is lower-cased and split into
+// alphanumeric words ("Domino's" -> "dominos"). Every query word must match;
+// a word matches its exact token, the last word also matches as a prefix, and
+// a word with no such match falls back to its closest tokens within one edit
+// (two for words longer than five letters). Not thread-safe: add and search
+// from one thread.
+class RestaurantSearch {
+private:
+    SearchVocabulary vocabulary;
+    TokenPostings names, dishes;
+    std::vector<Restaurant*> restaurants;  // by search id, null once removed
+    static const size_t MaxPrefixTokens = 256;
+
+    static std::vector<std::string> tokenize(std::string_view text) {
+        std::vector<std::string> words(1);
+        for (char c : text) {
+            if (std::isalnum((unsigned char)c)) words.back() += (char)std::tolower((unsigned char)c);
+            else if (c != '\'' && !words.back().empty()) words.emplace_back();
+        }
+        if (words.back().empty()) words.pop_back();
+        return words;
+    }
+
+    std::vector<uint32_t> tokenIdsOf(std::string_view text) {
+        std::vector<uint32_t> ids;
+        for (auto& word : tokenize(text)) ids.push_back(vocabulary.add(word));
+        return ids;
+    }
+
+    std::vector<Restaurant*> search(const TokenPostings& index, const std::string& query, size_t limit) {
+        std::vector<std::string> words = tokenize(query);
+        std::vector<std::vector<uint32_t>> matches(words.size());
+        size_t driver = 0, driverDocs = SIZE_MAX;
+        for (size_t w = 0; w < words.size(); w++) {
+            uint32_t exact = vocabulary.find(words[w]);
+            // Tokens that only occur in the other index (a dish word in a
+            // name search) are skipped so they cannot shadow real matches.
+            auto inIndex = [&](uint32_t token) { return !index.docsWith(token).empty(); };
+            if (exact != StringPool::None && inIndex(exact)) matches[w].push_back(exact);
+            if (w + 1 == words.size()) {
+                vocabulary.withPrefix(words[w], MaxPrefixTokens, matches[w],
+                                      [&](uint32_t token) { return token != exact && inIndex(token); });
+            }
+            if (matches[w].empty()) vocabulary.similarTo(words[w], words[w].size() > 5 ? 2 : 1, matches[w], inIndex);
+            size_t docs = 0;
+            for (uint32_t token : matches[w]) docs += index.docsWith(token).size();
+            if (docs < driverDocs) {
+                driver = w;
+                driverDocs = docs;
+            }
+        }
+        std::vector<Restaurant*> found;
+        if (words.empty()) return found;
+        std::vector<std::vector<uint32_t>> sortedMatches = matches;
+        for (auto& tokens : sortedMatches) std::sort(tokens.begin(), tokens.end());
+        // Walk the rarest word's postings, exact token first, and check the
+        // other words against each candidate's forward list.
+        for (uint32_t token : matches[driver]) {
+            for (uint32_t doc : index.docsWith(token)) {
+                if (!restaurants[doc]) continue;
+                bool all = true;
+                for (size_t w = 0; w < words.size() && all; w++) {
+                    if (w != driver) all = index.docHasAny(doc, sortedMatches[w]);
+                }
+                if (!all || std::find(found.begin(), found.end(), restaurants[doc]) != found.end()) continue;
+                found.push_back(restaurants[doc]);
+                if (found.size() == limit) return found;
+            }
+        }
+        return found;
+    }
+
+public:
+    int add(Restaurant* restaurant) {
+        uint32_t id = (uint32_t)restaurants.size();
+        restaurants.push_back(restaurant);
+        names.add(id, tokenIdsOf(restaurant->name));
+        std::vector<uint32_t> dishTokens;
+        for (auto& dish : restaurant->menu) {
+            for (uint32_t token : tokenIdsOf(dish)) dishTokens.push_back(token);
+        }
+        dishes.add(id, std::move(dishTokens));
+        return (int)id;
+    }
+
+    void remove(int id) {
+        if (id >= 0 && id < (int)restaurants.size()) restaurants[id] = nullptr;
+    }
+
+    std::vector<Restaurant*> byName(const std::string& query, size_t limit = 10) { return search(names, query, limit); }
+
+    std::vector<Restaurant*> byDish(const std::string& query, size_t limit = 10) { return search(dishes, query, limit); }
+
+    size_t vocabularySize() const { return vocabulary.size(); }
+
+    // Drops the slack left by growing posting lists; call after a bulk load.
+    void shrinkToFit() {
+        names.shrinkToFit();
+        dishes.shrinkToFit();
+        restaurants.shrink_to_fit();
+    }
+
+    size_t memoryBytes() const {
+        return vocabulary.memoryBytes() + names.memoryBytes() + dishes.memoryBytes() +
+               restaurants.capacity() * sizeof(Restaurant*);
     }
 };
 
 class ZomatoSystem {
 private:
-    static ZomatoSystem* instance;
     std::unordered_map<std::string, Restaurant> restaurants;
+    RestaurantSearch search;
+    OrderEventStream statusEvents;
+    OrderStore orders{&statusEvents};
+    std::vector<std::unique_ptr<DeliveryPartner>> partners;
+    std::vector<Location> partnerStarts;
+    std::unique_ptr<DeliveryDispatcher> dispatcher;
+    std::unique_ptr<OrderPipeline> pipeline;
 
     ZomatoSystem() {}  // Private constructor for Singleton
 
 public:
+    // Function-local static: initialised exactly once even if the first
+    // calls race.
     static ZomatoSystem* getInstance() {
-        if (!instance) instance = new ZomatoSystem();
-        return instance;
+        static ZomatoSystem instance;
+        return &instance;
     }
 
-    void addRestaurant(std::string name, std::vector<std::string> menu) {
-        restaurants[name] = Restaurant(name, menu);
+    // Re-adding a name updates that restaurant in place, so Restaurant*
+    // pointers held by orders and earlier search results stay valid.
+    void addRestaurant(std::string name, std::vector<std::string> menu, Location at = {}) {
+        auto [it, added] = restaurants.try_emplace(name, name, menu, at);
+        Restaurant& restaurant = it->second;
+        if (!added) {
+            search.remove(restaurant.searchId);
+            restaurant.menu = std::move(menu);
+            restaurant.location = at;
+        }
+        restaurant.searchId = search.add(&restaurant);
     }
 
     Restaurant* findRestaurant(std::string name) {
-        if (restaurants.find(name) != restaurants.end()) return &restaurants[name];
+        auto it = restaurants.find(name);
+        if (it != restaurants.end()) return &it->second;
         return nullptr;
     }
+
+    // Name lookup that tolerates prefixes and small typos.
+    std::vector<Restaurant*> searchRestaurants(const std::string& query, size_t limit = 10) {
+        return search.byName(query, limit);
+    }
+
+    std::vector<Restaurant*> findRestaurantsServing(const std::string& dish, size_t limit = 10) {
+        return search.byDish(dish, limit);
+    }
+
+    void addDeliveryPartner(std::string name, Location at = {}) {
+        partners.push_back(std::make_unique<DeliveryPartner>(name));
+        partnerStarts.push_back(at);
+    }
+
+    // Restaurants and partners must be registered before the pipeline starts.
+    // Partners are matched to ready orders by a dispatcher covering a
+    // 60 km x 60 km metro area from the origin; orders no partner within
+    // 5 km takes by `pickupTimeout` are cancelled.
+    void startPipeline(int workersPerStage, std::chrono::milliseconds dispatchInterval = std::chrono::milliseconds(200),
+                       std::chrono::milliseconds pickupTimeout = std::chrono::minutes(30)) {
+        std::vector<DeliveryPartner*> available;
+        dispatcher = std::make_unique<DeliveryDispatcher>(Location{0, 0}, 60, 60, 0.5, 5, DeliveryDispatcher::BATCHED,
+                                                          dispatchInterval);
+        for (size_t i = 0; i < partners.size(); i++) {
+            available.push_back(partners[i].get());
+            dispatcher->addPartner(partners[i].get(), partnerStarts[i]);
+        }
+        pipeline = std::make_unique<OrderPipeline>(orders, available);
+        pipeline->dispatchWith(dispatcher.get());
+        pipeline->cancelUnpickedAfter(pickupTimeout);
+        pipeline->start(workersPerStage);
+    }
+
+    // Position ping from a partner's app.
+    void updatePartnerLocation(DeliveryPartner& partner, Location at) {
+        if (dispatcher && partner.dispatchId >= 0) dispatcher->reportPosition(partner.dispatchId, at);
+    }
+
+    void stopPipeline() {
+        if (pipeline) pipeline->stop();
+    }
+
+    // Safe to call from any number of threads once the pipeline is running.
+    // Returns the new order's id, or 0 if the pipeline is not running. Throws
+    // std::length_error if the store has handed out every order id.
+    int placeOrder(std::string user, Restaurant& restaurant, std::vector<std::string> items, Location deliverTo = {}) {
+        if (!pipeline || !pipeline->isRunning()) {
+            logActivity("Order from " + user + " rejected: the order pipeline is not running");
+            return 0;
+        }
+        Order* order = orders.create(user, &restaurant, restaurant.name, items, deliverTo);
+        pipeline->submit(*order);
+        return order->orderId;
+    }
+
+    Order* getOrder(int orderId) { return orders.get(orderId); }
+
+    // Live status for apps, restaurants and partners: subscribe, then poll.
+    OrderEventStream& orderEvents() { return statusEvents; }
+
+    std::vector<int> getOrdersOfUser(const std::string& user) { return orders.ordersOfUser(user); }
+
+    std::vector<int> getOrdersAtRestaurant(const std::string& restaurant) { return orders.ordersAtRestaurant(restaurant); }
+
+    bool cancelOrder(int orderId) {
+        Order* order = orders.get(orderId);
+        return order && order->cancel();
+    }
+};
+
+class User {
+public:
+    std::string name;
+    Location address;
+
+    User(std::string n, Location at = {}) : name(n), address(at) {}
+
+    int placeOrder(Restaurant& restaurant, std::vector<std::string> items) {
+        logActivity(name + " placed an order at " + restaurant.name);
+        return ZomatoSystem::getInstance()->placeOrder(name, restaurant, items, address);
+    }
 };
-ZomatoSystem* ZomatoSystem::instance = nullptr;
 
-int main() {
+void benchmarkStatusFanOut() {
+    const int subscribers = 100000, bursts = 10, eventsPerBurst = 100;
+    const int events = bursts * eventsPerBurst;
+    int pollers = std::max(1u, std::thread::hardware_concurrency());
+    OrderEventStream stream(1 << 16);
+    std::vector<OrderEventStream::Subscription> subscriptions(subscribers, stream.subscribe());
+    std::vector<int64_t> publishedAt(events);
+    // lastSeen[p][e]: when poller p's slice last delivered event e; the
+    // slowest slice decides when an event has reached every subscriber.
+    std::vector<std::vector<int64_t>> lastSeen(pollers, std::vector<int64_t>(events));
+    std::vector<uint64_t> deliveries(pollers);
+    std::atomic<bool> publishing{true};
+    int64_t start = nowNanos();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < pollers; p++) {
+        threads.emplace_back([&, p] {
+            size_t from = (size_t)subscribers * p / pollers, to = (size_t)subscribers * (p + 1) / pollers;
+            while (true) {
+                bool done = !publishing.load(std::memory_order_acquire);
+                int64_t sweepAt = nowNanos();
+                for (size_t i = from; i < to; i++) {
+                    deliveries[p] += stream.poll(subscriptions[i], [&](const OrderEvent& event) {
+                        lastSeen[p][event.orderId] = sweepAt;
+                    });
+                }
+                if (done) break;
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (int b = 0; b < bursts; b++) {
+        for (int e = b * eventsPerBurst; e < (b + 1) * eventsPerBurst; e++) {
+            publishedAt[e] = nowNanos();
+            stream.publish(e, OrderStatus::PREPARING);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    publishing.store(false, std::memory_order_release);
+    for (auto& thread : threads) thread.join();
+    double seconds = (nowNanos() - start) / 1e9;
+    std::vector<int64_t> fanOut(events);
+    uint64_t delivered = 0, missed = 0;
+    for (int e = 0; e < events; e++) {
+        for (int p = 0; p < pollers; p++) fanOut[e] = std::max(fanOut[e], lastSeen[p][e] - publishedAt[e]);
+    }
+    for (int p = 0; p < pollers; p++) delivered += deliveries[p];
+    for (auto& subscription : subscriptions) missed += subscription.missed;
+    std::sort(fanOut.begin(), fanOut.end());
+    std::cout << "status stream: " << subscribers << " subscribers, " << pollers << " pollers, " << delivered
+              << " deliveries (" << missed << " missed), " << delivered / seconds / 1e6
+              << "M deliveries/s; time to reach all subscribers p50 " << fanOut[events / 2] / 1000 << " us, p99 "
+              << fanOut[events * 99 / 100] / 1000 << " us, max " << fanOut.back() / 1000 << " us\n";
+}
+
+void benchmarkOrderStore() {
+    std::ostream* savedLog = activityLog;
+    activityLog = nullptr;
+    const int ordersPerThread = 200000, userCount = 100000, restaurantCount = 10000;
+    std::vector<std::string> users, restaurantNames;
+    for (int i = 0; i < userCount; i++) users.push_back("U" + std::to_string(i));
+    for (int i = 0; i < restaurantCount; i++) restaurantNames.push_back("R" + std::to_string(i));
+    // Each thread places orders, moves each one along, reads it back by id
+    // and every 16th time lists the user's orders, like the order screen.
+    for (int threads : {1, 2, 4, 8}) {
+        OrderStore store;
+        std::atomic<uint64_t> lookedUp{0};
+        int64_t start = nowNanos();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                std::mt19937 rng(t);
+                uint64_t found = 0;
+                for (int i = 0; i < ordersPerThread; i++) {
+                    Order* order = store.create(users[rng() % userCount], nullptr, restaurantNames[rng() % restaurantCount], {});
+                    order->advance(OrderStatus::PLACED, OrderStatus::PREPARING);
+                    found += store.get(order->orderId) == order;
+                    if (i % 16 == 0) found += store.ordersOfUser(order->user).size();
+                }
+                lookedUp += found;
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        double seconds = (nowNanos() - start) / 1e9;
+        std::cout << "order store: " << threads << " threads, " << threads * ordersPerThread / seconds
+                  << " orders/s (" << store.size() << " ids, lookups returned " << lookedUp.load() << " orders)\n";
+    }
+    activityLog = savedLog;
+}
+
+void benchmarkOrderPipeline() {
+    std::ostream* savedLog = activityLog;
+    activityLog = nullptr;
+    const int restaurantCount = 1000, partnerCount = 5000;
+    std::vector<std::unique_ptr<Restaurant>> restaurants;
+    for (int i = 0; i < restaurantCount; i++) {
+        restaurants.push_back(std::make_unique<Restaurant>("R" + std::to_string(i), std::vector<std::string>{"Biryani", "Dosa"}));
+    }
+    std::vector<std::unique_ptr<DeliveryPartner>> partnerPool;
+    std::vector<DeliveryPartner*> partners;
+    for (int i = 0; i < partnerCount; i++) {
+        partnerPool.push_back(std::make_unique<DeliveryPartner>("P" + std::to_string(i)));
+        partners.push_back(partnerPool.back().get());
+    }
+    int workers = std::max(1u, std::thread::hardware_concurrency() / 3);
+
+    // Saturated: submit as fast as possible and time until all are delivered.
+    // Paced: a dinner peak of a steady arrival rate, timing each order.
+    for (int ratePerSecond : {0, 20000, 100000}) {
+        OrderStore store;
+        OrderPipeline pipeline(store, partners);
+        pipeline.start(workers);
+        const int orders = ratePerSecond ? ratePerSecond : 500000;
+        std::vector<Order*> placed;
+        placed.reserve(orders);
+        int64_t start = nowNanos();
+        for (int i = 0; i < orders; i++) {
+            if (ratePerSecond) {
+                int64_t due = start + (int64_t)i * 1000000000 / ratePerSecond;
+                while (nowNanos() < due) std::this_thread::yield();
+            }
+            Restaurant* restaurant = restaurants[i % restaurantCount].get();
+            Order* order = store.create("U" + std::to_string(i % 100000), restaurant, restaurant->name, {"Biryani"});
+            pipeline.submit(*order);
+            placed.push_back(order);
+        }
+        pipeline.stop();
+        double seconds = (nowNanos() - start) / 1e9;
+        std::vector<int64_t> latencies;
+        latencies.reserve(orders);
+        for (Order* order : placed) latencies.push_back(order->deliveredAtNs - order->placedAtNs);
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "pipeline (" << workers << " workers/stage, "
+                  << (ratePerSecond ? std::to_string(ratePerSecond) + " orders/s offered" : std::string("saturated"))
+                  << "): " << orders / seconds << " orders/s, latency p50 " << latencies[orders / 2] / 1000
+                  << " us, p99 " << latencies[orders * 99 / 100] / 1000 << " us, max " << latencies.back() / 1000 << " us\n";
+        for (auto& restaurant : restaurants) restaurant->orders.clear();
+    }
+    activityLog = savedLog;
+}
+
+void benchmarkRestaurantSearch() {
+    const int restaurantCount = 500000, queries = 20000;
+    std::mt19937 rng(7);
+    const std::vector<std::string> syllables = {"ka", "ri", "mo", "la", "zu", "pe", "ta", "shi", "no", "ra", "vi", "den",
+                                                "bar", "ko", "mi", "sa", "lu", "ga", "thu", "pa", "ne", "do", "ve", "har",
+                                                "jo", "ban", "si", "tor", "chi", "ma"};
+    const std::vector<std::string> kinds = {"Kitchen", "Dhaba", "Cafe", "Bistro", "Express", "House", "Corner", "Grill"};
+    const std::vector<std::string> cuisines = {"Punjabi", "Chinese", "Italian", "Mughlai", "Udupi", "Chettinad",
+                                               "Bengali", "Thai", "Mexican", "Kerala", "Hyderabadi", "Continental"};
+    const std::vector<std::string> bases = {"Biryani", "Dosa", "Pizza", "Burger", "Noodles", "Tikka", "Korma", "Kebab",
+                                            "Pasta", "Momos", "Thali", "Paratha", "Curry", "Tacos", "Rolls", "Sundae"};
+    const std::vector<std::string> styles = {"Chicken", "Paneer", "Mutton", "Veg", "Egg", "Prawn", "Masala", "Butter",
+                                             "Schezwan", "Tandoori", "Cheese", "Mushroom", "Fish", "Aloo", "Malai"};
+    auto brand = [&]() {
+        std::string word;
+        for (int i = 0, n = 2 + rng() % 2; i < n; i++) word += syllables[rng() % syllables.size()];
+        word[0] = (char)std::toupper(word[0]);
+        return word;
+    };
+    std::vector<std::unique_ptr<Restaurant>> restaurants;
+    RestaurantSearch search;
+    int64_t start = nowNanos();
+    for (int i = 0; i < restaurantCount; i++) {
+        std::vector<std::string> menu;
+        for (int d = 0; d < 8; d++) menu.push_back(styles[rng() % styles.size()] + " " + bases[rng() % bases.size()]);
+        std::string name = brand() + " " + cuisines[rng() % cuisines.size()] + " " + kinds[rng() % kinds.size()];
+        restaurants.push_back(std::make_unique<Restaurant>(name, std::move(menu)));
+        restaurants.back()->searchId = search.add(restaurants.back().get());
+    }
+    double buildSeconds = (nowNanos() - start) / 1e9;
+    search.shrinkToFit();
+    search.byName("warm up");  // sorts the vocabulary for prefix lookups
+
+    auto typo = [&](std::string word) {
+        size_t i = 1 + rng() % (word.size() - 2);
+        if (rng() % 2) std::swap(word[i], word[i + 1]);
+        else word[i] = (char)('a' + rng() % 26);
+        return word;
+    };
+    // Name prefixes, full two-word names, misspelt brands, dishes and
+    // misspelt dishes, in equal parts.
+    std::vector<std::pair<int, std::string>> workload;
+    for (int i = 0; i < queries; i++) {
+        const std::string& name = restaurants[rng() % restaurantCount]->name;
+        std::string first = name.substr(0, name.find(' '));
+        std::string dish = styles[rng() % styles.size()] + " " + bases[rng() % bases.size()];
+        switch (i % 5) {
+            case 0: workload.push_back({0, first.substr(0, 3 + rng() % 3)}); break;
+            case 1: workload.push_back({0, name.substr(0, name.rfind(' '))}); break;
+            case 2: workload.push_back({0, typo(first)}); break;
+            case 3: workload.push_back({1, dish}); break;
+            case 4: workload.push_back({1, typo(bases[rng() % bases.size()])}); break;
+        }
+    }
+    std::vector<int64_t> latencies;
+    size_t hits = 0, empty = 0;
+    for (auto& query : workload) {
+        int64_t begin = nowNanos();
+        auto found = query.first ? search.byDish(query.second, 10) : search.byName(query.second, 10);
+        latencies.push_back(nowNanos() - begin);
+        hits += found.size();
+        empty += found.empty();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "search: " << restaurantCount << " restaurants, " << search.vocabularySize() << " tokens, index "
+              << search.memoryBytes() / (1 << 20) << " MB (" << search.memoryBytes() / restaurantCount
+              << " bytes/restaurant), built in " << buildSeconds << " s; " << queries << " queries p50 "
+              << latencies[queries / 2] / 1000.0 << " us, p99 " << latencies[queries * 99 / 100] / 1000.0 << " us, max "
+              << latencies.back() / 1000.0 << " us, " << empty << " with no results\n";
+}
+
+void benchmarkDispatch() {
+    const int partnerCount = 100000, ordersPerBatch = 10000, restaurantCount = 20000;
+    const double cityKm = 60;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(0, cityKm);
+    std::vector<std::unique_ptr<Restaurant>> restaurants;
+    for (int i = 0; i < restaurantCount; i++) {
+        restaurants.push_back(std::make_unique<Restaurant>("R" + std::to_string(i), std::vector<std::string>{},
+                                                           Location{coord(rng), coord(rng)}));
+    }
+    std::vector<std::unique_ptr<DeliveryPartner>> partners;
+    std::vector<Location> starts;
+    for (int i = 0; i < partnerCount; i++) {
+        partners.push_back(std::make_unique<DeliveryPartner>("P" + std::to_string(i)));
+        starts.push_back({coord(rng), coord(rng)});
+    }
+    // Demand clusters around the busiest 1% of restaurants, as at dinner.
+    std::vector<std::unique_ptr<Order>> orders;
+    for (int i = 0; i < ordersPerBatch; i++) {
+        Restaurant* restaurant = restaurants[rng() % 4 ? rng() % (restaurantCount / 100) : rng() % restaurantCount].get();
+        orders.push_back(std::make_unique<Order>(i + 1, "U", restaurant, restaurant->name, std::vector<std::string>{}));
+    }
+
+    for (auto strategy : {DeliveryDispatcher::FIRST_COME, DeliveryDispatcher::BATCHED}) {
+        DeliveryDispatcher dispatcher({0, 0}, cityKm, cityKm, 0.5, 5, strategy);
+        for (int i = 0; i < partnerCount; i++) dispatcher.addPartner(partners[i].get(), starts[i]);
+        std::vector<Order*> pending;
+        for (auto& order : orders) pending.push_back(order.get());
+        std::vector<std::pair<Order*, DeliveryPartner*>> assigned;
+        int64_t start = nowNanos();
+        dispatcher.matchBatch(pending, assigned);
+        double ms = (nowNanos() - start) / 1e6;
+        std::vector<double> pickupKm;
+        for (auto& match : assigned) {
+            pickupKm.push_back(starts[match.second->dispatchId].distanceTo(match.first->kitchen->location));
+        }
+        std::sort(pickupKm.begin(), pickupKm.end());
+        double total = 0;
+        for (double km : pickupKm) total += km;
+        std::cout << "dispatch " << (strategy == DeliveryDispatcher::BATCHED ? "batched" : "first-come")
+                  << ": matched " << assigned.size() << "/" << ordersPerBatch << " orders to " << partnerCount
+                  << " partners in " << ms << " ms, pickup km mean " << total / pickupKm.size() << ", p95 "
+                  << pickupKm[pickupKm.size() * 95 / 100] << ", max " << pickupKm.back() << "\n";
+    }
+
+    // Partners ping their position every few seconds; the grid absorbs them
+    // at the start of each batch.
+    DeliveryDispatcher dispatcher({0, 0}, cityKm, cityKm);
+    for (int i = 0; i < partnerCount; i++) dispatcher.addPartner(partners[i].get(), starts[i]);
+    const int pings = 2000000;
+    std::vector<Order*> none;
+    std::vector<std::pair<Order*, DeliveryPartner*>> assigned;
+    int64_t start = nowNanos();
+    for (int i = 0; i < pings; i++) {
+        int partner = i % partnerCount;
+        Location& at = starts[partner];
+        at.x = std::min(cityKm, std::max(0.0, at.x + (int)(rng() % 3 - 1) * 0.05));
+        at.y = std::min(cityKm, std::max(0.0, at.y + (int)(rng() % 3 - 1) * 0.05));
+        dispatcher.reportPosition(partner, at);
+        if (i % 100000 == 99999) dispatcher.matchBatch(none, assigned);
+    }
+    std::cout << "dispatch position updates: " << pings / ((nowNanos() - start) / 1e9) << " pings/s\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        benchmarkStatusFanOut();
+        benchmarkOrderStore();
+        benchmarkRestaurantSearch();
+        benchmarkDispatch();
+        benchmarkOrderPipeline();
+        return 0;
+    }
     ZomatoSystem* zomato = ZomatoSystem::getInstance();
 
-    zomato->addRestaurant("Domino's", {"Pizza", "Pasta", "Burger"});
-    zomato->addRestaurant("McDonald's", {"Fries", "Burger", "Coke"});
+    zomato->addRestaurant("Domino's", {"Pizza", "Pasta", "Burger"}, {2, 3});
+    zomato->addRestaurant("McDonald's", {"Fries", "Burger", "Coke"}, {5, 1});
+    zomato->addDeliveryPartner("Ravi", {2.5, 3.5});
+    zomato->addDeliveryPartner("Suresh", {9, 9});
+    zomato->startPipeline(1, std::chrono::milliseconds(20));
+
+    for (Restaurant* match : zomato->searchRestaurants("mcdonlds")) std::cout << "Search 'mcdonlds': " << match->name << std::endl;
+    for (Restaurant* match : zomato->findRestaurantsServing("burg")) std::cout << "Serving 'burg': " << match->name << std::endl;
 
-    User user("Anand");
+    User user("Anand", {4, 4});
     Restaurant* restaurant = zomato->findRestaurant("Domino's");
 
     if (restaurant) {
-        Order order = user.placeOrder(*restaurant, {"Pizza", "Burger"});
-        DeliveryPartner deliveryBoy("Ravi");
-        deliveryBoy.deliverOrder(order);
+        OrderEventStream::Subscription everything = zomato->orderEvents().subscribe();
+        int orderId = user.placeOrder(*restaurant, {"Pizza", "Burger"});
+        int cancelledId = user.placeOrder(*restaurant, {"Pasta"});
+        if (zomato->cancelOrder(cancelledId)) std::cout << "Order " << cancelledId << " cancelled" << std::endl;
+        zomato->stopPipeline();
+        std::cout << user.name << " has " << zomato->getOrdersOfUser(user.name).size() << " order(s)" << std::endl;
+        zomato->orderEvents().poll(everything, [](const OrderEvent& event) {
+            std::cout << "[Status feed] Order " << event.orderId << " -> " << statusName(event.status) << std::endl;
+        });
+        std::cout << "Order " << orderId << " is " << zomato->getOrder(orderId)->getStatusString()
+                  << "; " << restaurant->name << " has " << restaurant->orders.size() << " order(s)" << std::endl;
     }
 
     return 0;